@@ -0,0 +1,287 @@
+#include "main.h"
+#include "../../src/dip.h"
+#include "../../src/parsers.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cmath>
+
+// count heap allocations made by the benchmarked code
+static std::atomic<size_t> num_heap_allocations = 0;
+
+void* operator new(size_t size) {
+  num_heap_allocations++;
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, [[maybe_unused]] size_t size) noexcept {
+  std::free(p);
+}
+
+// generate a synthetic DIP code with a given number of parameter lines
+std::string generate_code(const size_t num_lines) {
+  std::ostringstream oss;
+  for (size_t i=0; i<num_lines; i++) {
+    switch (i%8) {
+    case 0: oss << "group" << i << "  # group comment" << std::endl; break;
+    case 1: oss << "  count" << i << " int = " << i << std::endl; break;
+    case 2: oss << "  length" << i << " float = " << i << ".5e-3 cm" << std::endl; break;
+    case 3: oss << "  flag" << i << " bool = true  # inline comment" << std::endl; break;
+    case 4: oss << "  label" << i << " str = 'label" << i << "'" << std::endl; break;
+    case 5: oss << "    !descr 'description of a label'" << std::endl; break;
+    case 6: oss << "  grid" << i << " float64[3] = [1.0, 2.0, 3.0] m" << std::endl; break;
+    case 7: oss << "  mask" << i << " bool[2,2] = [[true,false],[false,true]]" << std::endl; break;
+    }
+  }
+  return oss.str();
+}
+
+void bench_parse_code_nodes(const size_t num_lines, const int repeat) {
+  std::string code = generate_code(num_lines);
+  dip::ParserMode default_mode = dip::Parser::default_mode;
+  for (dip::ParserMode mode: {dip::ParserMode::Regex, dip::ParserMode::Lexer}) {
+    dip::Parser::default_mode = mode;
+    double time = measure([&]() {
+      std::queue<dip::Line> lines;
+      dip::parse_lines(lines, code, "BENCH");
+      dip::parse_code_nodes(lines);
+    }, repeat);
+    report((mode==dip::ParserMode::Regex) ? "parse_code_nodes (regex)" : "parse_code_nodes (lexer)", num_lines, time);
+  }
+  dip::Parser::default_mode = default_mode;
+  size_t num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  double time = measure([&]() {
+    std::queue<dip::Line> lines;
+    dip::parse_lines(lines, code, "BENCH");
+    dip::parse_code_nodes(lines, num_threads);
+  }, repeat);
+  report("parse_code_nodes ("+std::to_string(num_threads)+" thr)", num_lines, time);
+}
+
+void bench_parse(const size_t num_lines, const int repeat) {
+  std::string code = generate_code(num_lines);
+  size_t num_allocations = num_heap_allocations;
+  double time = measure([&]() {
+    dip::DIP d;
+    d.add_string(code);
+    d.parse();
+  }, repeat);
+  num_allocations = (num_heap_allocations-num_allocations)/repeat;
+  report("parse", num_lines, time);
+  std::cout << std::left << std::setw(30) << "  heap allocations" << std::right << std::setw(12) << num_allocations << std::endl;
+}
+
+void bench_parse_cases(const size_t num_lines, const int repeat) {
+  // every branch has an active and an inactive case
+  std::ostringstream oss;
+  for (size_t i=0; i<num_lines/8; i++) {
+    oss << "block" << i << std::endl;
+    oss << "  @case " << ((i%2) ? "true" : "false") << std::endl;
+    oss << "    count int = " << i << std::endl;
+    oss << "    length float = " << i << ".5 cm" << std::endl;
+    oss << "  @case " << ((i%2) ? "false" : "true") << std::endl;
+    oss << "    count int = " << i+1 << std::endl;
+    oss << "    length float = " << i+1 << ".5 cm" << std::endl;
+    oss << "  @end" << std::endl;
+  }
+  std::string code = oss.str();
+  for (bool lazy: {false, true}) {
+    double time = measure([&]() {
+      dip::DIP d;
+      d.set_lazy(lazy);
+      d.add_string(code);
+      d.parse();
+    }, repeat);
+    report(lazy ? "parse (cases, lazy)" : "parse (cases)", num_lines, time);
+  }
+}
+
+void bench_parse_stream(const size_t num_lines, const int repeat) {
+  std::string code = generate_code(num_lines);
+  double time = measure([&]() {
+    std::istringstream stream(code);
+    size_t num_nodes = 0;
+    dip::DIP d;
+    d.parse_stream(stream, [&](dip::BaseNode::PointerType node) {num_nodes++;});
+  }, repeat);
+  report("parse_stream", num_lines, time);
+}
+
+void bench_request_value(const size_t num_lines, const int repeat) {
+  std::string code = generate_code(num_lines);
+  dip::DIP d;
+  d.add_string(code);
+  dip::Environment env = d.parse();
+  double time = measure([&]() {
+    for (size_t i=0; i<env.nodes.size(); i++) {
+      dip::BaseNode::PointerType node = env.nodes.at(i);
+      env.request_value("?"+node->name, dip::RequestType::Reference, node->units_raw);
+    }
+  }, repeat);
+  report("request_value", env.nodes.size(), time);
+}
+
+void bench_node_casts(const size_t num_lines, const int repeat) {
+  std::string code = generate_code(num_lines);
+  std::queue<dip::Line> lines;
+  dip::parse_lines(lines, code, "BENCH");
+  dip::BaseNode::NodeListType nodes = dip::parse_code_nodes(lines);
+  size_t num_values = 0;
+  double time = measure([&]() {
+    for (const auto& node: nodes) {
+      dip::ValueNode::PointerType vnode = std::dynamic_pointer_cast<dip::ValueNode>(node);
+      dip::QuantityNode::PointerType qnode = std::dynamic_pointer_cast<dip::QuantityNode>(node);
+      num_values += (vnode!=nullptr) + (qnode!=nullptr);
+    }
+  }, repeat);
+  report("node casts (dynamic)", nodes.size(), time);
+  time = measure([&]() {
+    for (const auto& node: nodes) {
+      dip::ValueNode::PointerType vnode = dip::to_value_node(node);
+      dip::QuantityNode::PointerType qnode = dip::to_quantity_node(node);
+      num_values += (vnode!=nullptr) + (qnode!=nullptr);
+    }
+  }, repeat);
+  report("node casts (dtype)", nodes.size(), time);
+  if (num_values==0)
+    std::cout << "no value nodes found" << std::endl;
+}
+
+void bench_table_lookup(const size_t num_lines, const int repeat) {
+  std::string code = generate_code(num_lines);
+  dip::DIP d;
+  d.add_string(code);
+  dip::Environment env = d.parse();
+  std::vector<std::string> names;
+  for (size_t i=0; i<env.nodes.size(); i++)
+    if (env.nodes.at(i)->dtype==dip::NodeDtype::Integer)
+      names.push_back(env.nodes.at(i)->name);
+  long long total = 0;
+  double time = measure([&]() {
+    for (const std::string& name: names) {
+      dip::ValueNode::PointerType vnode = std::dynamic_pointer_cast<dip::ValueNode>(env.nodes.find(name));
+      total += static_cast<int>(*vnode->value);
+    }
+  }, repeat);
+  report("node_list lookup", names.size(), time);
+  dip::NodeTable table = env.table();
+  time = measure([&]() {
+    for (const std::string& name: names)
+      total += table.values<int>(table.find(name))[0];
+  }, repeat);
+  report("node_table lookup", names.size(), time);
+  if (total==0)
+    std::cout << "no values found" << std::endl;
+}
+
+void bench_request_nodes(const size_t num_lines, const int repeat) {
+  std::string code = generate_code(num_lines);
+  dip::DIP d;
+  d.add_string(code);
+  dip::Environment env = d.parse();
+  size_t num_groups = num_lines/8;
+  double time = measure([&]() {
+    for (size_t i=0; i<num_groups; i++)
+      env.request_nodes("?group"+std::to_string(i*8), dip::RequestType::Reference);
+  }, repeat);
+  report("request_nodes", num_groups, time);
+}
+
+void bench_cast_arrays(const size_t num_values, const int repeat) {
+  dip::Array::StringType integers(num_values), floats(num_values);
+  for (size_t i=0; i<num_values; i++) {
+    integers[i] = std::to_string(i);
+    floats[i] = std::to_string(i)+".25e-3";
+  }
+  long long total = 0;
+  double time = measure([&]() {
+    std::vector<int> arr;
+    arr.reserve(integers.size());
+    for (auto s: integers) arr.push_back(std::stoi(s));
+    total += arr.back();
+  }, repeat);
+  report("cast int32 (stoi)", num_values, time);
+  time = measure([&]() {
+    total += dip::parse_numbers<int>(integers).back();
+  }, repeat);
+  report("cast int32 (from_chars)", num_values, time);
+  time = measure([&]() {
+    std::vector<double> arr;
+    arr.reserve(floats.size());
+    for (auto s: floats) arr.push_back(std::stod(s));
+    total += arr.back();
+  }, repeat);
+  report("cast float64 (stod)", num_values, time);
+  time = measure([&]() {
+    total += dip::parse_numbers<double>(floats).back();
+  }, repeat);
+  report("cast float64 (from_chars)", num_values, time);
+  // whole array node including the array literal parsing
+  std::ostringstream oss;
+  oss << "grid float[" << num_values << "] = [";
+  for (size_t i=0; i<num_values; i++)
+    oss << ((i>0) ? "," : "") << floats[i];
+  oss << "]";
+  std::string code = oss.str();
+  time = measure([&]() {
+    dip::DIP d;
+    d.add_string(code);
+    d.parse();
+  }, repeat);
+  report("parse (float array)", num_values, time);
+  if (total==0)
+    std::cout << "no values found" << std::endl;
+}
+
+void bench_slice_arrays(const size_t num_values, const int repeat) {
+  // square grid with the given number of values sliced into small blocks
+  int side = std::max(static_cast<int>(std::sqrt(num_values)), 16);
+  std::vector<double> grid(side*side);
+  for (size_t i=0; i<grid.size(); i++)
+    grid[i] = i;
+  dip::BaseValue::PointerType value = std::make_unique<dip::ArrayValue<double>>(grid, dip::Array::ShapeType({side, side}), dip::ValueDtype::Float64);
+  size_t num_slices = 1000;
+  double total = 0;
+  double time = measure([&]() {
+    for (size_t i=0; i<num_slices; i++) {
+      int row = (i*7)%(side-16);
+      dip::BaseValue::PointerType block = value->slice({{row,row+15},{4,19}});
+      total += static_cast<double>(*block->slice({{0,0},{0,0}}));
+    }
+  }, repeat);
+  report("slice 16x16 of "+std::to_string(side)+"x"+std::to_string(side), num_slices, time);
+  if (total<0)
+    std::cout << "negative values found" << std::endl;
+}
+
+int main(int argc, char * argv[]) {
+  std::string name = (argc>1) ? argv[1] : "all";
+  size_t size = (argc>2) ? std::stoul(argv[2]) : 50000;
+  int repeat = (argc>3) ? std::stoi(argv[3]) : 3;
+  if (name=="all" or name=="parse_code_nodes")
+    bench_parse_code_nodes(size, repeat);
+  if (name=="all" or name=="parse")
+    bench_parse(size, repeat);
+  if (name=="all" or name=="parse_cases")
+    bench_parse_cases(size, repeat);
+  if (name=="all" or name=="parse_stream")
+    bench_parse_stream(size, repeat);
+  if (name=="all" or name=="request_value")
+    bench_request_value(size, repeat);
+  if (name=="all" or name=="node_casts")
+    bench_node_casts(size, repeat);
+  if (name=="all" or name=="table_lookup")
+    bench_table_lookup(size, repeat);
+  if (name=="all" or name=="request_nodes")
+    bench_request_nodes(size, repeat);
+  if (name=="all" or name=="cast_arrays")
+    bench_cast_arrays(size, repeat);
+  if (name=="all" or name=="slice_arrays")
+    bench_slice_arrays(size, repeat);
+}
@@ -0,0 +1,32 @@
+#ifndef MAIN_H
+#define MAIN_H
+
+#include <iostream>
+#include <iomanip>
+#include <exception>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+// measure average wall time of a benchmark function in milliseconds
+inline double measure(const std::function<void()>& func, const int repeat) {
+  double total = 0;
+  for (int i=0; i<repeat; i++) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    total += std::chrono::duration<double, std::milli>(end - start).count();
+  }
+  return total/repeat;
+}
+
+// print a single benchmark result
+inline void report(const std::string& name, const size_t size, const double time) {
+  std::cout << std::left << std::setw(30) << name;
+  std::cout << std::right << std::setw(12) << size;
+  std::cout << std::setw(14) << std::fixed << std::setprecision(3) << time << " ms";
+  std::cout << std::setw(14) << std::setprecision(1) << 1e6*time/size << " ns/item" << std::endl;
+}
+
+#endif // MAIN_H
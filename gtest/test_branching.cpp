@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <regex>
 
 #include "../src/dip.h"
 #include "../src/environment.h"
@@ -156,3 +157,115 @@ TEST(Branchig, NestedBranches) {
   EXPECT_EQ(node->name, "weight");          
   
 }
+
+TEST(Branchig, CleanName) {
+
+  std::shared_ptr<dip::PathTable> paths = std::make_shared<dip::PathTable>();
+  dip::BranchingList branching(paths);
+  EXPECT_EQ(branching.clean_name("foo.bar"), "foo.bar");
+  EXPECT_EQ(branching.clean_name("@C1.foo"), "foo");
+  EXPECT_EQ(branching.clean_name("foo.@C12.bar.@C3.baz"), "foo.bar.baz");
+  EXPECT_EQ(branching.clean_name("foo.@Cx.bar"), "foo.@Cx.bar");
+  EXPECT_EQ(branching.clean_path(paths->intern(0, "foo.@C12.bar.@C3.baz")), paths->intern(0, "foo.bar.baz"));
+
+  // names have to be cleaned in the same way as with the original regular expression
+  std::regex pattern("(@C[0-9]+.)");
+  for (const std::string name: {"foo@C1.bar", "a.foo@C2.b@C13.c", "@C4.foo@C5.bar", "foo.@C12", "foo.@C1",
+				"foo@C3bar", "foo.@C", "@C6.@C7.baz"}) {
+    std::string expected = std::regex_replace(name, pattern, "");
+    EXPECT_EQ(branching.clean_name(name), expected);
+    EXPECT_EQ(branching.clean_path(paths->intern(0, name)), paths->intern(0, expected));
+  }
+
+  // case markers within a segment come from cases without a separator
+  dip::DIP d;
+  d.add_string("foo@case true");
+  d.add_string("  bar int = 1");
+  d.add_string("  @case true");
+  d.add_string("    baz int = 2");
+  d.add_string("  @end");
+  d.add_string("@end");
+  dip::Environment env = d.parse();
+  EXPECT_EQ(env.nodes.size(), 2);
+  EXPECT_EQ(env.nodes.at(0)->name, "foobar");
+  EXPECT_EQ(env.nodes.at(1)->name, "foobaz");
+  
+}
+
+TEST(Branchig, ReturnFromNestedBranch) {
+
+  // state of the outer case has to be restored when a nested branch closes
+  dip::DIP d;
+  d.add_string("@case false");
+  d.add_string("  a int = 1");
+  d.add_string("@case true");
+  d.add_string("  @case false");
+  d.add_string("    b int = 2");
+  d.add_string("  @end");
+  d.add_string("  c int = 3");            // this is taken
+  d.add_string("@case true");
+  d.add_string("  @case true");
+  d.add_string("    d int = 4");          // this should be ignored
+  d.add_string("  @end");
+  d.add_string("  e int = 5");            // this should be ignored
+  d.add_string("@end");
+  d.add_string("f int = 6");              // this is taken
+  dip::Environment env = d.parse();
+  EXPECT_EQ(env.nodes.size(), 2);
+  EXPECT_EQ(env.nodes.at(0)->name, "c");
+  EXPECT_EQ(env.nodes.at(1)->name, "f");
+  
+}
+
+TEST(Branchig, LazyCases) {
+
+  std::vector<std::string> code = {
+    "man",
+    "  @case false",
+    "    age int = 30",
+    "  @else",
+    "    age int = 40",
+    "      !options [30,40]",
+    "    @case true",
+    "      weight float = 80 kg",
+    "        !constant",
+    "    @end",
+    "  height float = 180 cm",
+    "@case true",
+    "  @case false",
+    "    $source foo = missing.dip",
+    "  @else",
+    "    size float = {?man.height} cm",
+    "  @end",
+    "@end",
+  };
+  // lazy nodes give the same result as nodes classified in advance
+  for (bool lazy: {false, true}) {
+    dip::DIP d;
+    d.set_lazy(lazy);
+    for (auto& line: code)
+      d.add_string(line);
+    dip::Environment env = d.parse();
+    std::ostringstream oss;
+    for (size_t i=0; i<env.nodes.size(); i++)
+      oss << env.nodes.at(i)->name << " ";
+    EXPECT_EQ(oss.str(), "man.age man.weight man.height size ");
+    dip::ValueNode::PointerType vnode = dip::to_value_node(env.nodes.at(0));
+    EXPECT_EQ(vnode->value->to_string(), "40");
+    vnode = dip::to_value_node(env.nodes.at(1));
+    EXPECT_TRUE(vnode->constant);
+  }
+
+  // syntax of inactive branches is not validated
+  dip::DIP d;
+  d.set_lazy(true);
+  d.add_string("@case false");
+  d.add_string("  age int = 30 30");
+  d.add_string("@else");
+  d.add_string("  age int = 40");
+  d.add_string("@end");
+  dip::Environment env = d.parse();
+  EXPECT_EQ(env.nodes.size(), 1);
+  EXPECT_EQ(env.nodes.at(0)->name, "age");
+  
+}
@@ -34,3 +34,37 @@ TEST(Hierarchy, GroupNodes) {
   EXPECT_EQ(node->name, "foo.bar");
 
 }
+
+TEST(Hierarchy, InternedPaths) {
+
+  // paths are composed from a parent path and leaf symbols
+  dip::PathTable paths;
+  dip::PathId foo = paths.intern(0, "hfoo");
+  dip::PathId bar = paths.intern(foo, "bar");
+  EXPECT_EQ(paths.intern(0, "hfoo.bar"), bar);
+  EXPECT_EQ(paths.path_name(bar), "hfoo.bar");
+  EXPECT_EQ(paths.find("hfoo.bar"), bar);
+  EXPECT_EQ(paths.find("hfoo.unknown"), 0);
+  EXPECT_EQ(paths.path_symbols(bar).size(), 2);
+  EXPECT_EQ(paths.symbol_name(paths.path_symbols(bar).at(1)), "bar");
+
+  // names of parsed nodes are interned in the table of their environment and cleaned from cases
+  dip::DIP d;
+  d.add_string("hfoo\n  @case true\n    bar int = 3\n  @end");
+  dip::Environment env = d.parse();
+  ASSERT_EQ(env.nodes.size(), 1);
+  EXPECT_EQ(env.nodes.at(0)->name, "hfoo.bar");
+  EXPECT_EQ(env.nodes.at(0)->path, env.paths->find("hfoo.bar"));
+  EXPECT_EQ(env.nodes.at(0)->path_table, env.paths->id());
+  EXPECT_EQ(paths.find("hfoo.bar"), bar);
+
+  // tables are shared by copies of the environment, but not between DIPs
+  dip::Environment copy = env;
+  EXPECT_EQ(copy.paths, env.paths);
+  dip::DIP d2;
+  d2.add_string("hfoo\n  bar int = 4");
+  dip::Environment env2 = d2.parse();
+  EXPECT_NE(env2.paths, env.paths);
+  EXPECT_EQ(env2.nodes.find("hfoo.bar")->path_table, env2.paths->id());
+  
+}
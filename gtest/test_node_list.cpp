@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include "../src/dip.h"
+#include "../src/environment.h"
+#include "../src/nodes/nodes.h"
+
+dip::BaseNode::PointerType create_node(const std::string& name, const size_t indent) {
+  dip::Parser parser(dip::Line(name, dip::Source()));
+  dip::BaseNode::PointerType node = std::make_shared<dip::EmptyNode>(parser);
+  node->name = name;
+  node->indent = indent;
+  return node;
+}
+
+TEST(NodeList, FindByName) {
+
+  dip::NodeList nodes;
+  nodes.push_back(create_node("a", 0));
+  nodes.push_back(create_node("b", 1));
+  nodes.push_front(create_node("c", 2));
+  nodes.push_back(create_node("a", 3));
+  nodes.push_front(create_node("b", 4));
+  EXPECT_EQ(nodes.size(), 5);
+  EXPECT_EQ(nodes.find("d"), nullptr);
+
+  // the last node with a given name is returned
+  EXPECT_EQ(nodes.find("a")->indent, 3);
+  EXPECT_EQ(nodes.find("b")->indent, 1);
+  EXPECT_EQ(nodes.find("c")->indent, 2);
+
+  // index is updated when nodes are removed
+  EXPECT_EQ(nodes.pop_back()->indent, 3);
+  EXPECT_EQ(nodes.find("a")->indent, 0);
+  EXPECT_EQ(nodes.pop_front()->indent, 4);
+  EXPECT_EQ(nodes.find("b")->indent, 1);
+  EXPECT_EQ(nodes.pop_front()->indent, 2);
+  EXPECT_EQ(nodes.find("c"), nullptr);
+  EXPECT_EQ(nodes.pop_back()->indent, 1);
+  EXPECT_EQ(nodes.find("b"), nullptr);
+  EXPECT_EQ(nodes.find("a")->indent, 0);
+  EXPECT_EQ(nodes.at(0)->indent, 0);
+  
+}
+
+TEST(NodeList, Redefinition) {
+
+  dip::DIP d;
+  d.add_string("foo int = 3");
+  d.add_string("bar float = 2.5");
+  d.add_string("foo int = 4");
+  d.add_string("baz int = {?foo}");
+  d.add_string("bar = 3.5");
+  dip::Environment env = d.parse();
+  EXPECT_EQ(env.nodes.size(), 3);
+  
+  dip::ValueNode::PointerType vnode = std::dynamic_pointer_cast<dip::ValueNode>(env.nodes.find("foo"));
+  EXPECT_EQ(vnode->value->to_string(), "4");
+  vnode = std::dynamic_pointer_cast<dip::ValueNode>(env.nodes.find("bar"));
+  EXPECT_EQ(vnode->value->to_string(), "3.5000");
+  vnode = std::dynamic_pointer_cast<dip::ValueNode>(env.nodes.at(2));
+  EXPECT_EQ(vnode->name, "baz");
+  EXPECT_EQ(vnode->value->to_string(), "4");
+  
+}
+
+TEST(NodeList, FindPrefix) {
+
+  dip::NodeList nodes;
+  nodes.push_back(create_node("a.b", 0));
+  nodes.push_back(create_node("ab.c", 1));
+  nodes.push_back(create_node("a.c.d", 2));
+  nodes.push_front(create_node("a.e", 3));
+  nodes.push_back(create_node("b.a", 4));
+  nodes.push_back(create_node("a.b", 5));
+
+  // nodes are returned in the order of the list
+  dip::BaseNode::NodeListType found = nodes.find_prefix("a.");
+  ASSERT_EQ(found.size(), 4);
+  EXPECT_EQ(found.at(0)->indent, 3);
+  EXPECT_EQ(found.at(1)->indent, 0);
+  EXPECT_EQ(found.at(2)->indent, 2);
+  EXPECT_EQ(found.at(3)->indent, 5);
+
+  EXPECT_EQ(nodes.find_prefix("a.c.").size(), 1);
+  EXPECT_EQ(nodes.find_prefix("c.").size(), 0);
+  EXPECT_EQ(nodes.find_prefix("").size(), 6);
+
+  // copies of the list have their own index
+  dip::NodeList copy = nodes;
+  nodes.pop_front();
+  EXPECT_EQ(nodes.find_prefix("a.").size(), 3);
+  EXPECT_EQ(copy.find_prefix("a.").size(), 4);
+  EXPECT_EQ(copy.find("a.e")->indent, 3);
+  
+}
+
+TEST(NodeTable, FinalizedNodes) {
+
+  dip::DIP d;
+  d.add_string("count int = 3");
+  d.add_string("size uint64 = 12345678901");
+  d.add_string("grid float[2,2] = [[1,2],[3,4]] m");
+  d.add_string("flags bool[3] = [true,false,true]");
+  d.add_string("label str = 'bar'");
+  d.add_string("  !constant");
+  d.add_string("speed float = 3 m/s");
+  d.add_string("count = 4");
+  dip::Environment env = d.parse();
+  dip::NodeTable table = env.table();
+  EXPECT_EQ(table.size(), 6);
+
+  // modified values are stored only once
+  size_t count = table.find("count");
+  ASSERT_EQ(count, 0);
+  EXPECT_EQ(table.name(count), "count");
+  EXPECT_EQ(table.dtype(count), dip::ValueDtype::Integer32);
+  EXPECT_FALSE(table.is_array(count));
+  EXPECT_EQ(table.values<int>(count)[0], 4);
+  EXPECT_EQ(table.unit_id(count), 0);
+  EXPECT_EQ(table.values<unsigned long long>(table.find("size"))[0], 12345678901ULL);
+
+  // arrays are stored flat together with their shapes
+  size_t grid = table.find("grid");
+  EXPECT_TRUE(table.is_array(grid));
+  EXPECT_EQ(std::vector<int>(table.shape(grid).begin(), table.shape(grid).end()), std::vector<int>({2,2}));
+  std::span<const double> grid_values = table.values<double>(grid);
+  EXPECT_EQ(std::vector<double>(grid_values.begin(), grid_values.end()), std::vector<double>({1,2,3,4}));
+  EXPECT_EQ(table.units(grid), "m");
+  std::span<const uint8_t> flags = table.values<uint8_t>(table.find("flags"));
+  EXPECT_EQ(std::vector<uint8_t>(flags.begin(), flags.end()), std::vector<uint8_t>({1,0,1}));
+
+  // properties and units
+  size_t label = table.find("label");
+  EXPECT_TRUE(table.is_constant(label));
+  EXPECT_EQ(table.values<std::string>(label)[0], "bar");
+  EXPECT_EQ(table.units(table.find("speed")), "m/s");
+  EXPECT_NE(table.unit_id(table.find("speed")), table.unit_id(grid));
+  
+  // unknown names and wrong value types
+  EXPECT_EQ(table.find("missing"), dip::NodeTable::npos);
+  EXPECT_THROW(table.values<double>(count), std::runtime_error);
+
+  // every call reflects the current nodes
+  env.nodes.pop_back();
+  EXPECT_EQ(env.table().size(), 5);
+  EXPECT_EQ(env.table().find("speed"), dip::NodeTable::npos);
+  EXPECT_EQ(table.size(), 6);
+  
+}
+
+TEST(NodeList, NodeCasts) {
+
+  // value and quantity nodes are recognized from their data types
+  std::vector<dip::BaseNode::PointerType> nodes = {
+    dip::create_scalar_node<bool>("a", true),
+    dip::create_scalar_node<int>("b", 1),
+    dip::create_scalar_node<double>("c", 1.0),
+    dip::create_scalar_node<std::string>("d", "foo"),
+    create_node("e", 0)
+  };
+  for (const auto& node: nodes) {
+    EXPECT_EQ(dip::to_value_node(node), std::dynamic_pointer_cast<dip::ValueNode>(node)) << node->name;
+    EXPECT_EQ(dip::to_quantity_node(node), std::dynamic_pointer_cast<dip::QuantityNode>(node)) << node->name;
+  }
+  EXPECT_EQ(nodes[1]->dtype, dip::NodeDtype::Integer);
+  EXPECT_EQ(dip::to_value_node(nullptr), nullptr);
+  
+}
@@ -3,6 +3,7 @@
 #include "../src/dip.h"
 #include "../src/environment.h"
 #include "../src/nodes/nodes.h"
+#include "../src/parsers.h"
 
 TEST(ParseArrays, BooleanValue) {
   
@@ -99,3 +100,56 @@ TEST(ParseArrays, ArrayToScalarsError) {
 
 }
 
+
+TEST(ParseArrays, NumericLiteral) {
+
+  dip::Array::ShapeType shape;
+  std::vector<float> numbers = dip::parse_array_numbers<float>("[[1, 2.5],\n [3e2, -4]]", shape);
+  EXPECT_EQ(numbers, std::vector<float>({1,2.5,3e2,-4}));
+  EXPECT_EQ(shape, dip::Array::ShapeType({2,2}));
+
+  dip::DIP d;
+  d.add_string("foo float32[3] = [1,2,3e3]");
+  d.add_string("bar float32[3] = {?foo}");
+  dip::Environment env = d.parse();
+  // numeric arrays keep their literal in the line buffer next to the element strings
+  EXPECT_EQ(env.nodes.at(0)->value_raw, dip::Array::StringType({"1","2","3e3"}));
+  EXPECT_EQ(env.nodes.at(0)->value_literal, "[1,2,3e3]");
+  EXPECT_EQ(env.nodes.at(1)->value_raw, dip::Array::StringType({"foo"}));
+  EXPECT_TRUE(env.nodes.at(1)->value_literal.empty());
+  dip::ValueNode::PointerType vnode = dip::to_value_node(env.nodes.at(1));
+  EXPECT_EQ(vnode->value->to_string(), "[1.0000, 2.0000, 3000.0]");
+  EXPECT_EQ(vnode->value->dtype, dip::ValueDtype::Float32);
+
+  try {
+    dip::parse_array_numbers<int>("[[1,2],[3]]", shape);
+    FAIL() << "Expected std::runtime_error";
+  } catch (const std::runtime_error& e) {
+    EXPECT_STREQ(e.what(), "Items in dimension 2 do not have the same shape: [[1,2],[3]]");
+  } catch (...) {
+    FAIL() << "Expected std::runtime_error";
+  }
+
+}
+
+TEST(ParseArrays, BooleanMask) {
+
+  std::vector<bool> mask;
+  for (int i=0; i<200; i++)
+    mask.push_back(i%3==0);
+  dip::ArrayValue<bool> value(mask, {2,100});
+  EXPECT_EQ(value.count(), 67);
+  EXPECT_TRUE(value.any());
+  EXPECT_FALSE(value.all());
+  std::vector<uint8_t> bytes = value.to_bytes();
+  EXPECT_EQ(bytes.size(), 200);
+  EXPECT_EQ(bytes.at(99), 1);
+  EXPECT_EQ(bytes.at(100), 0);
+
+  // slices crossing word boundaries are packed again
+  dip::BaseValue::PointerType sliced = value.slice({{1,1},{60,70}});
+  dip::ArrayValue<bool> expected(std::vector<bool>({false,false,true,false,false,true,false,false,true,false,false}), {11});
+  EXPECT_TRUE(*sliced==&expected);
+  EXPECT_FALSE(value==&expected);
+
+}
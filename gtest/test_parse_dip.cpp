@@ -32,3 +32,74 @@ TEST(DIP, Addfile) {
   std::filesystem::remove(temp_filename);
   
 }
+
+TEST(DIP, ParseTwice) {
+
+  dip::DIP d;
+  d.add_string("foo int = 3");
+  dip::Environment env1 = d.parse();
+  dip::Environment env2 = d.parse();
+  ASSERT_EQ(env1.nodes.size(), 1);
+  ASSERT_EQ(env2.nodes.size(), 1);
+  EXPECT_NE(env1.nodes.at(0), env2.nodes.at(0));
+  EXPECT_EQ(dip::to_value_node(env2.nodes.at(0))->value->to_string(), "3");
+
+  // every parse includes all code added so far
+  d.add_string("bar int = 4\nfoo = 5");
+  dip::Environment env3 = d.parse();
+  ASSERT_EQ(env3.nodes.size(), 2);
+  EXPECT_EQ(dip::to_value_node(env3.nodes.at(0))->value->to_string(), "5");
+  EXPECT_EQ(dip::to_value_node(env3.nodes.at(1))->value->to_string(), "4");
+  EXPECT_EQ(dip::to_value_node(env1.nodes.at(0))->value->to_string(), "3");
+  
+}
+
+TEST(DIP, LeanMode) {
+
+  std::weak_ptr<const dip::SourceBuffer> buffer;
+  dip::Environment env;
+  {
+    dip::DIP d;
+    d.add_string("foo int = 3\nbar float[3] = [1,2,3] m");
+    buffer = d.parse().nodes.at(0)->line.buffer;
+    d.set_lean(true);
+    env = d.parse();
+  }
+  // values are kept, raw strings and source code are released
+  ASSERT_EQ(env.nodes.size(), 2);
+  dip::ValueNode::PointerType vnode = dip::to_value_node(env.nodes.at(1));
+  EXPECT_EQ(vnode->value->to_string(), "[1.0000, 2.0000, 3.0000]");
+  EXPECT_TRUE(vnode->value_raw.empty());
+  EXPECT_TRUE(vnode->line.code.empty());
+  EXPECT_TRUE(buffer.expired());
+  EXPECT_EQ(env.request_value("?bar", dip::RequestType::Reference, "cm")->to_string(), "[100.00, 200.00, 300.00]");
+  
+  // sources are released as well
+  std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+  std::string source_filename = (temp_dir / "example_lean.dip").string();
+  {
+    std::ofstream source_file(source_filename);
+    ASSERT_TRUE(source_file.is_open()) << "Failed to create temp file.";
+    source_file << "baz int = 5";
+  }
+  dip::DIP ds;
+  ds.set_lean(true);
+  ds.add_string("$source src = "+source_filename);
+  ds.add_string("baz int = {src?baz}");
+  dip::Environment senv = ds.parse();
+  EXPECT_EQ(dip::to_value_node(senv.nodes.at(0))->value->to_string(), "5");
+  const dip::Environment& csenv = senv;
+  EXPECT_EQ(csenv.sources.at("src").code, nullptr);
+  EXPECT_EQ(csenv.sources.at("src").nodes.size(), 0);
+  std::filesystem::remove(source_filename);
+
+  // line locations remain for error messages
+  EXPECT_EQ(vnode->line.source.line_number, 1);
+  try {
+    env.request_value("?bar", dip::RequestType::Reference);
+    FAIL() << "Expected std::runtime_error";
+  } catch (const std::runtime_error& e) {
+    EXPECT_STREQ(e.what(), ("Trying to convert 'm' into a nondimensional quantity: ["+vnode->line.source.name()+":1]").c_str());
+  }
+  
+}
@@ -53,6 +53,44 @@ TEST(ParseScalars, IntegerValue) {
   
 }
 
+TEST(ParseScalars, IntegerRange) {
+
+  dip::DIP d;
+  d.add_string("foo1 uint32 = 3000000000");
+  d.add_string("foo2 int16 = -32768");
+  d.add_string("foo3 uint64 = +18446744073709551615");
+  d.add_string("foo4 int16[3] = [1,-2,32767]");
+  dip::Environment env = d.parse();
+  EXPECT_EQ(dip::to_value_node(env.nodes.at(0))->value->to_string(), "3000000000");
+  EXPECT_EQ(dip::to_value_node(env.nodes.at(1))->value->to_string(), "-32768");
+  EXPECT_EQ(dip::to_value_node(env.nodes.at(2))->value->to_string(), "18446744073709551615");
+  EXPECT_EQ(dip::to_value_node(env.nodes.at(3))->value->to_string(), "[1, -2, 32767]");
+
+  // values out of the type range, or with trailing characters, are not truncated
+  for (std::string code: {"foo uint16 = 65536", "foo uint32 = -1", "foo int16[2] = [1,40000]",
+			  "foo int = 12a", "foo float32 = 1e40", "foo float = 1.5.2"}) {
+    dip::DIP d_err;
+    d_err.add_string(code);
+    EXPECT_THROW(d_err.parse(), std::runtime_error) << code;
+  }
+  
+}
+
+TEST(ParseScalars, StringCasts) {
+
+  // casts of string values accept leading numbers as before, unlike the parsed node values
+  dip::BaseValue::PointerType decimal = std::make_unique<dip::ScalarValue<std::string>>("3.5");
+  dip::BaseValue::PointerType exponent = std::make_unique<dip::ScalarValue<std::string>>(" 2.5e1");
+  dip::BaseValue::PointerType text = std::make_unique<dip::ScalarValue<std::string>>("12 apples");
+  dip::BaseValue::PointerType word = std::make_unique<dip::ScalarValue<std::string>>("apples");
+  EXPECT_EQ(static_cast<int>(*decimal), 3);
+  EXPECT_EQ(static_cast<double>(*exponent), 25);
+  EXPECT_EQ(static_cast<long long>(*text), 12);
+  EXPECT_THROW(static_cast<int>(*word), std::runtime_error);
+  EXPECT_THROW(dip::parse_number<int>("3.5"), std::runtime_error);
+  
+}
+
 TEST(ParseScalars, FloatValue) {
 
   dip::DIP d;
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <sstream>
+
+#include "../src/dip.h"
+#include "../src/environment.h"
+#include "../src/nodes/nodes.h"
+
+const std::string STREAM_CODE = 
+  "foo int = 3\n"
+  "  !options [1,2,3]\n"
+  "bar\n"
+  "  baz float = 3.4 cm\n"
+  "    !constant\n"
+  "\n"
+  "  text str = \"\"\"first line\n"
+  "second line\"\"\"\n"
+  "  arr int[2] = [5, 6]  # comment\n"
+  "@case false\n"
+  "  valid bool = true\n"
+  "@else\n"
+  "  valid bool = false\n"
+  "@end\n"
+  "last str = 'end'";
+
+TEST(ParseStream, CompareWithParse) {
+
+  dip::DIP d;
+  d.add_string(STREAM_CODE);
+  dip::Environment env = d.parse();
+  EXPECT_EQ(env.nodes.size(), 6);
+  
+  // emitted nodes are the same for any chunk size
+  for (size_t chunk_size: {1, 7, 16, 65536}) {
+    std::istringstream stream(STREAM_CODE);
+    std::vector<dip::BaseNode::PointerType> nodes;
+    dip::DIP ds;
+    dip::Environment senv = ds.parse_stream(stream, [&](dip::BaseNode::PointerType node) {
+      nodes.push_back(node);
+    }, chunk_size);
+    EXPECT_EQ(senv.nodes.size(), 0);
+    ASSERT_EQ(nodes.size(), env.nodes.size());
+    for (size_t i=0; i<nodes.size(); i++) {
+      dip::ValueNode::PointerType vnode = std::dynamic_pointer_cast<dip::ValueNode>(env.nodes.at(i));
+      dip::ValueNode::PointerType snode = std::dynamic_pointer_cast<dip::ValueNode>(nodes.at(i));
+      EXPECT_EQ(snode->name, vnode->name);
+      EXPECT_EQ(snode->value->to_string(), vnode->value->to_string());
+      EXPECT_EQ(snode->line.code, vnode->line.code);
+      EXPECT_EQ(snode->line.source.line_number, vnode->line.source.line_number);
+      EXPECT_EQ(snode->constant, vnode->constant);
+    }
+  }
+  
+}
+
+TEST(ParseStream, Validation) {
+
+  // properties are validated before nodes are emitted
+  std::istringstream stream("foo int = 4\n  !options [1,2,3]\n");
+  dip::DIP d;
+  EXPECT_THROW(d.parse_stream(stream, [](dip::BaseNode::PointerType node) {}), std::runtime_error);
+
+  // emitted nodes are not kept and cannot be modified
+  std::istringstream stream_mod("foo int = 4\nfoo = 5\n");
+  dip::DIP d_mod;
+  EXPECT_THROW(d_mod.parse_stream(stream_mod, [](dip::BaseNode::PointerType node) {}, 4), std::runtime_error);
+
+  // sources cannot be parsed in advance
+  std::istringstream stream_src("foo int = 4\n");
+  dip::DIP d_src;
+  d_src.set_source_threads(2);
+  EXPECT_THROW(d_src.parse_stream(stream_src, [](dip::BaseNode::PointerType node) {}), std::runtime_error);
+  
+}
+
+TEST(ParseStream, Modes) {
+
+  dip::DIP d;
+  d.add_string(STREAM_CODE);
+  dip::Environment env = d.parse();
+
+  // lazy and lean modes give the same values for any chunk size
+  for (size_t chunk_size: {1, 7, 65536}) {
+    std::istringstream stream(STREAM_CODE);
+    std::vector<dip::BaseNode::PointerType> nodes;
+    dip::DIP ds;
+    ds.set_lazy(true);
+    ds.set_lean(true);
+    ds.set_parse_threads(2);
+    ds.parse_stream(stream, [&](dip::BaseNode::PointerType node) {
+      nodes.push_back(node);
+    }, chunk_size);
+    ASSERT_EQ(nodes.size(), env.nodes.size());
+    for (size_t i=0; i<nodes.size(); i++) {
+      dip::ValueNode::PointerType vnode = dip::to_value_node(env.nodes.at(i));
+      dip::ValueNode::PointerType snode = dip::to_value_node(nodes.at(i));
+      EXPECT_EQ(snode->name, vnode->name);
+      EXPECT_EQ(snode->value->to_string(), vnode->value->to_string());
+      EXPECT_TRUE(snode->value_raw.empty());
+    }
+  }
+  
+}
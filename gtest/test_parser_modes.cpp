@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <queue>
+#include <sstream>
+
+#include "../src/dip.h"
+#include "../src/parsers.h"
+#include "../src/nodes/nodes.h"
+
+// parse code lines with a given parser mode and restore the default mode afterwards
+dip::BaseNode::NodeListType parse_with_mode(const std::string& code, const dip::ParserMode mode) {
+  dip::ParserMode default_mode = dip::Parser::default_mode;
+  dip::Parser::default_mode = mode;
+  std::queue<dip::Line> lines;
+  dip::parse_lines(lines, code, "MODES");
+  dip::BaseNode::NodeListType nodes = dip::parse_code_nodes(lines);
+  dip::Parser::default_mode = default_mode;
+  return nodes;
+}
+
+void expect_same_nodes(const std::string& code) {
+  dip::BaseNode::NodeListType rnodes = parse_with_mode(code, dip::ParserMode::Regex);
+  dip::BaseNode::NodeListType lnodes = parse_with_mode(code, dip::ParserMode::Lexer);
+  ASSERT_EQ(rnodes.size(), lnodes.size());
+  for (size_t i=0; i<rnodes.size(); i++) {
+    EXPECT_EQ(rnodes[i]->dtype, lnodes[i]->dtype) << code;
+    EXPECT_EQ(rnodes[i]->indent, lnodes[i]->indent) << code;
+    EXPECT_EQ(rnodes[i]->name, lnodes[i]->name) << code;
+    EXPECT_EQ(rnodes[i]->dtype_raw, lnodes[i]->dtype_raw) << code;
+    EXPECT_EQ(rnodes[i]->value_raw, lnodes[i]->value_raw) << code;
+    EXPECT_EQ(rnodes[i]->value_shape, lnodes[i]->value_shape) << code;
+    EXPECT_EQ(rnodes[i]->value_origin, lnodes[i]->value_origin) << code;
+    EXPECT_EQ(rnodes[i]->value_slice, lnodes[i]->value_slice) << code;
+    EXPECT_EQ(rnodes[i]->units_raw, lnodes[i]->units_raw) << code;
+    EXPECT_EQ(rnodes[i]->dimension, lnodes[i]->dimension) << code;
+  }
+}
+
+void expect_same_error(const std::string& code) {
+  std::string rerror, lerror;
+  try {
+    parse_with_mode(code, dip::ParserMode::Regex);
+  } catch (const std::runtime_error& e) {
+    rerror = e.what();
+  }
+  try {
+    parse_with_mode(code, dip::ParserMode::Lexer);
+  } catch (const std::runtime_error& e) {
+    lerror = e.what();
+  }
+  EXPECT_FALSE(rerror.empty()) << code;
+  EXPECT_EQ(rerror, lerror);
+}
+
+TEST(ParserModes, ValueNodes) {
+
+  expect_same_nodes("foo int = 3");
+  expect_same_nodes("  foo uint16 = 3 km  # comment");
+  expect_same_nodes("foo float64[2,:] = [[1,2],[3,4]] m/s");
+  expect_same_nodes("foo float32 = {?bar}[1:2] cm");
+  expect_same_nodes("foo str = \"\"\"block\nstring\"\"\"");
+  expect_same_nodes("foo str = 'single' # comment");
+  expect_same_nodes("foo str = \"double \\\" quote\"");
+  expect_same_nodes("foo bool = ('{?a} && {?b}')");
+  expect_same_nodes("foo bool = (func)");
+  expect_same_nodes("foo bool");
+  expect_same_nodes("foo table = {src}");
+
+}
+
+TEST(ParserModes, OtherNodes) {
+
+  expect_same_nodes("# comment only");
+  expect_same_nodes("foo # group");
+  expect_same_nodes("foo = 3 km");
+  expect_same_nodes("{?foo}");
+  expect_same_nodes("bar {?foo}");
+  expect_same_nodes("(func)");
+  expect_same_nodes("$source src = file.dip");
+  expect_same_nodes("$unit length = 1*m");
+  expect_same_nodes("@case ('{?a} == 1')");
+  expect_same_nodes("  @else");
+  expect_same_nodes("@end # done");
+  expect_same_nodes("  !constant");
+  expect_same_nodes("  !options [1,2] km");
+  expect_same_nodes("  !descr \"description\"");
+  expect_same_nodes("  = 3");
+
+}
+
+TEST(ParserModes, Errors) {
+
+  expect_same_error("foo$ int = 3");
+  expect_same_error("foo int8 = 3");
+  expect_same_error("foo int = {}");
+  expect_same_error("foo str = (\"\")");
+  expect_same_error("foo int[] = [1]");
+  expect_same_error("foo int = 1 + 2");
+  expect_same_error("foo int = 1 *");
+  expect_same_error("$unit length = 1 m");
+
+}
+
+TEST(ParserModes, ParallelClassification) {
+
+  // lines are split between threads in chunks; block strings may cross chunk boundaries
+  std::ostringstream oss;
+  for (size_t i=0; i<5*dip::MIN_PARALLEL_LINES; i++) {
+    switch (i%5) {
+    case 0: oss << "group" << i << "  # comment" << std::endl; break;
+    case 1: oss << "  count" << i << " int = " << i << std::endl; break;
+    case 2: oss << "  label" << i << " str = \"\"\"first" << std::endl << "second\"\"\"" << std::endl; break;
+    case 3: oss << "    !descr 'escaped \\' quote'" << std::endl; break;
+    case 4: oss << "  grid" << i << " float64[2] = [1.0, 2.0] m" << std::endl; break;
+    }
+  }
+  std::queue<dip::Line> lines;
+  dip::parse_lines(lines, oss.str(), "PARALLEL");
+  std::queue<dip::Line> plines = lines;
+  dip::BaseNode::NodeListType snodes = dip::parse_code_nodes(lines);
+  dip::BaseNode::NodeListType pnodes = dip::parse_code_nodes(plines, 4);
+  ASSERT_EQ(snodes.size(), 5*dip::MIN_PARALLEL_LINES);
+  ASSERT_EQ(snodes.size(), pnodes.size());
+  for (size_t i=0; i<snodes.size(); i++) {
+    EXPECT_EQ(snodes[i]->dtype, pnodes[i]->dtype);
+    EXPECT_EQ(snodes[i]->name, pnodes[i]->name);
+    EXPECT_EQ(snodes[i]->value_raw, pnodes[i]->value_raw);
+    EXPECT_EQ(snodes[i]->line.code, pnodes[i]->line.code);
+    EXPECT_EQ(snodes[i]->line.source.line_number, pnodes[i]->line.source.line_number);
+  }
+
+  // the first invalid line in the code is reported
+  std::string code = oss.str();
+  code.insert(code.find("\ngroup", code.size()*3/4)+1, "last ?? invalid\n");
+  code.insert(code.find("\ngroup", code.size()/4)+1, "first ?? invalid\n");
+  std::queue<dip::Line> elines;
+  dip::parse_lines(elines, code, "PARALLEL");
+  try {
+    dip::parse_code_nodes(elines, 4);
+    FAIL() << "Expected std::runtime_error";
+  } catch (const std::runtime_error& e) {
+    EXPECT_NE(std::string(e.what()).find("first ?? invalid"), std::string::npos) << e.what();
+  }
+  
+}
@@ -108,3 +108,35 @@ TEST(ValueSlicing, ArrayToScalar) {
   EXPECT_EQ(vnode->value->to_string(), "4");
     
 }
+
+TEST(ValueSlicing, ThreeDimensions) {
+
+  dip::DIP d;
+  d.add_string("snap int[2,3,4] = [[[0,1,2,3],[4,5,6,7],[8,9,10,11]],[[12,13,14,15],[16,17,18,19],[20,21,22,23]]]");
+  d.add_string("crackle int[2,2,2] = {?snap}[:,1:2,2:3]");
+  d.add_string("pop int[3] = {?snap}[1,:,1]");
+  d.add_string("foo int[3,2] = {?snap}[1,:,0:1]");
+  dip::Environment env = d.parse();
+  EXPECT_EQ(env.nodes.size(), 4);
+  
+  dip::ValueNode::PointerType vnode = dip::to_value_node(env.nodes.at(1));
+  EXPECT_EQ(vnode->value->to_string(), "[[[6, 7], [10, 11]], [[18, 19], [22, 23]]]");
+  vnode = dip::to_value_node(env.nodes.at(2));
+  EXPECT_EQ(vnode->value->to_string(), "[13, 17, 21]");
+  vnode = dip::to_value_node(env.nodes.at(3));
+  EXPECT_EQ(vnode->value->to_string(), "[[12, 13], [16, 17], [20, 21]]");
+
+  // slice ranges are clipped to the array, but they have to select some elements
+  d = dip::DIP();
+  d.add_string("snap int[2,3] = [[1,2,3], [4,5,6]]");
+  d.add_string("crackle int = {?snap}[1,2:3]");
+  d.add_string("pop int[2] = {?snap}[0:5,0]");
+  env = d.parse();
+  EXPECT_EQ(dip::to_value_node(env.nodes.at(1))->value->to_string(), "6");
+  EXPECT_EQ(dip::to_value_node(env.nodes.at(2))->value->to_string(), "[1, 4]");
+  dip::DIP d_err;
+  d_err.add_string("snap int[2,3] = [[1,2,3], [4,5,6]]");
+  d_err.add_string("crackle int = {?snap}[1,3:4]");
+  EXPECT_THROW(d_err.parse(), std::runtime_error);
+  
+}
@@ -1,9 +1,12 @@
 #include <gtest/gtest.h>
 #include <fstream>
 #include <filesystem>
+#include <thread>
+#include <sys/stat.h>
 
 #include "../src/dip.h"
 #include "../src/environment.h"
+#include "../src/parsers.h"
 #include "../src/nodes/nodes.h"
 
 TEST(SourceList, KeywordSourceCode) {
@@ -31,8 +34,8 @@ TEST(SourceList, KeywordSourceCode) {
   dip::EnvSource& senv = env.sources.at(source_name);
   EXPECT_EQ(senv.name, source_name);
   EXPECT_EQ(senv.path, source_filename);
-  EXPECT_EQ(senv.code, source_code);
-  EXPECT_FALSE(senv.parent.name.empty());
+  EXPECT_EQ(*senv.code, source_code);
+  EXPECT_FALSE(senv.parent.name().empty());
   EXPECT_EQ(senv.nodes.size(), 2);
 
   dip::BaseNode::PointerType node = senv.nodes.at(0);
@@ -74,8 +77,8 @@ TEST(SourceList, KeywordSourceText) {
   dip::EnvSource& senv = env.sources.at(source_name);
   EXPECT_EQ(senv.name, source_name);
   EXPECT_EQ(senv.path, source_filename);
-  EXPECT_EQ(senv.code, source_code);
-  EXPECT_FALSE(senv.parent.name.empty());
+  EXPECT_EQ(*senv.code, source_code);
+  EXPECT_FALSE(senv.parent.name().empty());
   EXPECT_EQ(senv.nodes.size(), 0);
 
 }
@@ -105,8 +108,8 @@ TEST(SourceList, AddSourceCode) {
   dip::EnvSource& senv = env.sources.at(source_name);
   EXPECT_EQ(senv.name, source_name);
   EXPECT_EQ(senv.path, source_filename);
-  EXPECT_EQ(senv.code, source_code);
-  EXPECT_FALSE(senv.parent.name.empty());
+  EXPECT_EQ(*senv.code, source_code);
+  EXPECT_FALSE(senv.parent.name().empty());
   EXPECT_EQ(senv.nodes.size(), 2);
 
   dip::BaseNode::PointerType node = senv.nodes.at(0);
@@ -122,3 +125,309 @@ TEST(SourceList, AddSourceCode) {
   EXPECT_EQ(vnode->value->to_string(), "false");
 
 }
+
+TEST(SourceList, SharedSourceLines) {
+
+  std::string source_code = "foo int = 3\n\nbar str = 'a \\' b'";
+  
+  dip::DIP d;
+  d.add_string(source_code);
+  dip::Environment env = d.parse();
+  EXPECT_EQ(env.nodes.size(), 2);
+
+  // lines point into the source code buffer and share the source name
+  dip::BaseNode::PointerType node = env.nodes.at(0);
+  EXPECT_EQ(node->line.code, "foo int = 3");
+  EXPECT_EQ(node->line.source.line_number, 0);
+  dip::EnvSource& senv = env.sources.at(node->line.source.name());
+  EXPECT_EQ(*senv.code, source_code);
+  EXPECT_EQ(node->line.buffer, senv.code);
+  EXPECT_EQ(node->line.code.data(), senv.code->data());
+  EXPECT_EQ(node->line.source.name(), senv.name);
+  EXPECT_EQ(node->line.source.shared_name, env.nodes.at(1)->line.source.shared_name);
+
+  // lines with escaped symbols keep their original code
+  node = env.nodes.at(1);
+  EXPECT_EQ(node->line.code, "bar str = 'a \\' b'");
+  EXPECT_EQ(node->line.source.line_number, 2);
+  EXPECT_EQ(node->line.code.data(), senv.code->data()+13);
+  
+}
+
+TEST(SourceList, MappedSourceFile) {
+
+  // create temporary file
+  std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+  std::filesystem::path source_filename = temp_dir / "example_mapped.dip";
+  // files are mapped only if they are large enough
+  std::string source_code = "foo int = 3\nbar float[3] = {mapped_values}\n# "+std::string(dip::MIN_MAPPED_SIZE, '-');
+  std::string values_filename = (temp_dir / "example_mapped_values.txt").string();
+  {
+    std::ofstream source_file(source_filename);
+    ASSERT_TRUE(source_file.is_open()) << "Failed to create temp file.";
+    source_file << source_code;
+    std::ofstream values_file(values_filename);
+    ASSERT_TRUE(values_file.is_open()) << "Failed to create temp file.";
+    values_file << "[1.0,\n 2.0,\n 3.0]\n";
+  }
+  
+  // large regular files are memory-mapped and lines point directly into the mapping
+  dip::DIP d;
+  d.add_file(source_filename.string(), "mapped_source");
+  d.add_source("mapped_values", values_filename);
+  dip::Environment env = d.parse();
+
+  // remove temporary files
+  std::filesystem::remove(source_filename);
+  std::filesystem::remove(values_filename);
+  
+  dip::EnvSource& senv = env.sources.at("mapped_source");
+  EXPECT_TRUE(senv.code->is_mapped());
+  EXPECT_EQ(*senv.code, source_code);
+  EXPECT_FALSE(env.sources.at("mapped_values").code->is_mapped());
+  
+  EXPECT_EQ(env.nodes.size(), 2);
+  dip::BaseNode::PointerType node = env.nodes.at(0);
+  EXPECT_EQ(node->line.code.data(), senv.code->data());
+  dip::ValueNode::PointerType vnode = std::dynamic_pointer_cast<dip::ValueNode>(env.nodes.at(1));
+  EXPECT_EQ(vnode->value->to_string(), "[1.0000, 2.0000, 3.0000]");
+  
+}
+
+TEST(SourceList, PipedSourceFile) {
+
+  // create a named pipe
+  std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+  std::filesystem::path pipe_filename = temp_dir / "example_pipe.dip";
+  std::filesystem::remove(pipe_filename);
+  ASSERT_EQ(mkfifo(pipe_filename.c_str(), 0600), 0) << "Failed to create a named pipe.";
+  std::thread writer([&]() {
+    std::ofstream pipe_file(pipe_filename);
+    pipe_file << "foo int = 3\nbar bool = false";
+  });
+
+  // pipes cannot be mapped and are read into the memory
+  dip::DIP d;
+  d.add_file(pipe_filename.string(), "piped_source");
+  writer.join();
+  dip::Environment env = d.parse();
+
+  // remove the named pipe
+  std::filesystem::remove(pipe_filename);
+  
+  dip::EnvSource& senv = env.sources.at("piped_source");
+  EXPECT_FALSE(senv.code->is_mapped());
+  EXPECT_EQ(*senv.code, "foo int = 3\nbar bool = false");
+  EXPECT_EQ(env.nodes.size(), 2);
+  
+}
+
+TEST(SourceList, SharedBetweenParses) {
+
+  // create temporary file
+  std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+  std::filesystem::path source_filename = temp_dir / "example_shared.dip";
+  {
+    std::ofstream source_file(source_filename);
+    ASSERT_TRUE(source_file.is_open()) << "Failed to create temp file.";
+    source_file << "foo int = 3\nbar bool = false";
+  }
+  
+  dip::DIP d;
+  d.add_source("shared_source", source_filename.string());
+  d.add_string("foo int = {shared_source?foo}");
+  dip::Environment env1 = d.parse();
+
+  // the same DIP object can be parsed again after adding new code
+  d.add_string("foo = 4");
+  dip::Environment env2 = d.parse();
+
+  // remove temporary file
+  std::filesystem::remove(source_filename);
+
+  EXPECT_EQ(env1.nodes.size(), 1);
+  EXPECT_EQ(std::dynamic_pointer_cast<dip::ValueNode>(env1.nodes.at(0))->value->to_string(), "3");
+  EXPECT_EQ(env2.nodes.size(), 1);
+  EXPECT_EQ(std::dynamic_pointer_cast<dip::ValueNode>(env2.nodes.at(0))->value->to_string(), "4");
+
+  // sources are shared between environments until one of them is modified
+  const dip::Environment& cenv1 = env1;
+  const dip::Environment& cenv2 = env2;
+  EXPECT_EQ(&cenv1.sources.at("shared_source"), &cenv2.sources.at("shared_source"));
+  dip::EnvSource& senv = env1.sources.at("shared_source");
+  EXPECT_NE(&senv, &cenv2.sources.at("shared_source"));
+  EXPECT_EQ(senv.code, cenv2.sources.at("shared_source").code);
+  EXPECT_EQ(senv.nodes.size(), 2);
+  
+}
+
+TEST(SourceList, CachedSources) {
+
+  // create temporary file
+  std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+  std::filesystem::path source_filename = temp_dir / "example_cached.dip";
+  {
+    std::ofstream source_file(source_filename);
+    ASSERT_TRUE(source_file.is_open()) << "Failed to create temp file.";
+    source_file << "foo int = 3\nbar bool = false";
+  }
+  dip::clear_source_cache();
+
+  // the same file is parsed only once, also when it is imported under different names
+  dip::DIP d1;
+  d1.add_string("$source first = "+source_filename.string());
+  d1.add_string("$source second = "+source_filename.string());
+  d1.add_string("foo int = {second?foo}");
+  dip::Environment env1 = d1.parse();
+  dip::DIP d2;
+  d2.add_source("third", source_filename.string());
+  d2.add_string("{third?}");
+  dip::Environment env2 = d2.parse();
+  dip::SourceCacheStats stats = dip::source_cache_stats();
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(env1.nodes.size(), 1);
+  EXPECT_EQ(env2.nodes.size(), 2);
+  const dip::Environment& cenv1 = env1;
+  const dip::Environment& cenv2 = env2;
+  EXPECT_EQ(cenv1.sources.at("first").name, "first");
+  EXPECT_EQ(cenv1.sources.at("second").name, "second");
+  EXPECT_EQ(cenv2.sources.at("third").name, "third");
+  EXPECT_EQ(cenv1.sources.at("second").code, cenv2.sources.at("third").code);
+  // cached nodes refer to the file instead of the import name
+  std::string canonical_filename = std::filesystem::canonical(source_filename).string();
+  EXPECT_EQ(cenv1.sources.at("first").nodes.at(0), cenv2.sources.at("third").nodes.at(0));
+  EXPECT_EQ(cenv2.sources.at("third").nodes.at(0)->line.source.name(), canonical_filename);
+
+  // modified files are parsed again
+  {
+    std::ofstream source_file(source_filename);
+    ASSERT_TRUE(source_file.is_open()) << "Failed to create temp file.";
+    source_file << "foo int = 4";
+  }
+  dip::DIP d3;
+  d3.add_source("fourth", source_filename.string());
+  d3.add_string("{fourth?}");
+  dip::Environment env3 = d3.parse();
+  stats = dip::source_cache_stats();
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(env3.nodes.size(), 1);
+  EXPECT_EQ(std::dynamic_pointer_cast<dip::ValueNode>(env3.nodes.at(0))->value->to_string(), "4");
+  
+  // remove temporary file
+  std::filesystem::remove(source_filename);
+  
+}
+
+TEST(SourceList, CachedNestedSources) {
+
+  // create temporary files; the outer source imports the inner one
+  std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+  std::string inner_filename = (temp_dir / "example_cached_inner.dip").string();
+  std::string outer_filename = (temp_dir / "example_cached_outer.dip").string();
+  {
+    std::ofstream inner_file(inner_filename);
+    ASSERT_TRUE(inner_file.is_open()) << "Failed to create temp file.";
+    inner_file << "foo int = 3";
+    std::ofstream outer_file(outer_filename);
+    ASSERT_TRUE(outer_file.is_open()) << "Failed to create temp file.";
+    outer_file << "$source inner = " << inner_filename << "\nbar int = {inner?foo}";
+  }
+  dip::clear_source_cache();
+
+  dip::DIP d1;
+  d1.add_string("$source outer = "+outer_filename);
+  d1.add_string("{outer?}");
+  dip::Environment env1 = d1.parse();
+  EXPECT_EQ(dip::to_value_node(env1.nodes.at(0))->value->to_string(), "3");
+  dip::SourceCacheStats stats = dip::source_cache_stats();
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.hits, 0);
+
+  // a change of the nested file with the same size invalidates also the outer source
+  {
+    std::ofstream inner_file(inner_filename);
+    ASSERT_TRUE(inner_file.is_open()) << "Failed to create temp file.";
+    inner_file << "foo int = 5";
+  }
+  dip::DIP d2;
+  d2.add_string("$source outer = "+outer_filename);
+  d2.add_string("{outer?}");
+  dip::Environment env2 = d2.parse();
+  EXPECT_EQ(dip::to_value_node(env2.nodes.at(0))->value->to_string(), "5");
+  stats = dip::source_cache_stats();
+  EXPECT_EQ(stats.misses, 4);
+  EXPECT_EQ(stats.hits, 0);
+
+  // unchanged files are taken from the cache
+  dip::DIP d3;
+  d3.add_string("$source outer = "+outer_filename);
+  d3.add_string("{outer?}");
+  dip::Environment env3 = d3.parse();
+  EXPECT_EQ(dip::to_value_node(env3.nodes.at(0))->value->to_string(), "5");
+  stats = dip::source_cache_stats();
+  EXPECT_EQ(stats.misses, 4);
+  EXPECT_EQ(stats.hits, 1);
+  
+  // remove temporary files
+  std::filesystem::remove(inner_filename);
+  std::filesystem::remove(outer_filename);
+  
+}
+
+TEST(SourceList, ParallelSources) {
+
+  // create temporary files
+  std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+  std::vector<std::string> source_filenames;
+  for (int i=0; i<5; i++) {
+    source_filenames.push_back((temp_dir / ("example_parallel"+std::to_string(i)+".dip")).string());
+    std::ofstream source_file(source_filenames.back());
+    ASSERT_TRUE(source_file.is_open()) << "Failed to create temp file.";
+    source_file << "value int = " << i << "\n";
+    // sources can import other sources
+    if (i>0) source_file << "$source nested" << i << " = " << source_filenames.at(i-1) << "\n";
+  }
+
+  dip::DIP d;
+  d.set_source_threads(3);
+  for (int i=0; i<5; i++) {
+    d.add_string("$source src"+std::to_string(i)+" = "+source_filenames.at(i));
+    d.add_string("value"+std::to_string(i)+" int = {src"+std::to_string(i)+"?value}");
+  }
+  // sources in inactive cases are never added to the environment
+  d.add_string("@case false");
+  d.add_string("$source missing = "+(temp_dir / "example_parallel_missing.dip").string());
+  d.add_string("@end");
+  dip::Environment env = d.parse();
+
+  EXPECT_EQ(env.nodes.size(), 5);
+  for (int i=0; i<5; i++) {
+    dip::ValueNode::PointerType vnode = std::dynamic_pointer_cast<dip::ValueNode>(env.nodes.at(i));
+    EXPECT_EQ(vnode->name, "value"+std::to_string(i));
+    EXPECT_EQ(vnode->value->to_string(), std::to_string(i));
+  }
+  
+  // errors are reported when the source node is reached
+  dip::DIP d_err;
+  d_err.set_source_threads(2);
+  d_err.add_string("$source src = "+source_filenames.at(0));
+  d_err.add_string("$source missing = "+(temp_dir / "example_parallel_missing.dip").string());
+  EXPECT_THROW(d_err.parse(), std::runtime_error);
+
+  // sources in case branches are not parsed in advance
+  dip::clear_source_cache();
+  dip::DIP d_case;
+  d_case.set_source_threads(2);
+  d_case.add_string("@case false");
+  d_case.add_string("  $source skipped = "+source_filenames.at(0));
+  d_case.add_string("@end");
+  d_case.parse();
+  EXPECT_EQ(dip::source_cache_stats().misses, 0);
+  
+  // remove temporary files
+  for (auto& source_filename: source_filenames)
+    std::filesystem::remove(source_filename);
+  
+}
@@ -23,3 +23,28 @@ TEST(UnitList, Keyword) {
 }
 
 // TODO: modify puq so that one can set up custom units
+
+TEST(UnitList, ConversionCache) {
+
+  dip::DIP d;
+  d.add_string("foo float = 2000 m");
+  d.add_string("bar float = {?foo} km");
+  d.add_string("baz float = {?foo} km");
+  d.add_string("foo = 3 km");
+  dip::Environment env = d.parse();
+
+  dip::UnitCacheStats stats = env.units.cache_stats();
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(std::dynamic_pointer_cast<dip::ValueNode>(env.nodes.at(0))->value->to_string(), "3000.0");
+  EXPECT_EQ(std::dynamic_pointer_cast<dip::ValueNode>(env.nodes.at(1))->value->to_string(), "2.0000");
+
+  // copies of the environment share the cache
+  dip::Environment copy = env;
+  dip::UnitConversion conversion = copy.units.conversion("km", "m");
+  EXPECT_TRUE(conversion.linear);
+  EXPECT_DOUBLE_EQ(conversion.factor, 1000);
+  EXPECT_DOUBLE_EQ(conversion.offset, 0);
+  EXPECT_EQ(env.units.cache_stats().hits, 2);
+  
+}
@@ -95,7 +95,17 @@ TEST(Units, ArrayModification) {
   EXPECT_TRUE(qnode);
   EXPECT_EQ(qnode->value->to_string(), "[1.2000e+04, 2.3000e+04]");
   EXPECT_EQ(qnode->units->to_string(), "m");
-  
+
+  d = dip::DIP();
+  d.add_string("foo float32[3] = [23, 45, 67] m");
+  d.add_string("foo = [150, 2, 3] cm");
+  env = d.parse();
+
+  qnode = std::dynamic_pointer_cast<dip::QuantityNode>(env.nodes.at(0));
+  EXPECT_TRUE(qnode);
+  EXPECT_EQ(qnode->value->to_string(), "[1.5000, 0.02000, 0.03000]");
+  EXPECT_EQ(qnode->value->dtype, dip::ValueDtype::Float32);
+
 }
 
 TEST(Units, DimlessModification) {
@@ -251,3 +261,22 @@ TEST(Units, UnitConversionError) {
   
 }
 
+
+TEST(Units, IntegerConversion) {
+
+  // integer results are truncated unless they differ from an integer only by rounding errors
+  EXPECT_EQ(dip::convert_number<int>(3, 0.5, 0.0), 1);
+  EXPECT_EQ(dip::convert_number<int>(-3, 0.5, 0.0), -1);
+  EXPECT_EQ(dip::convert_number<int>(49, 1.0/49, 0.0), 1);
+  EXPECT_EQ(dip::convert_number<int>(2, 1000.0, 0.0), 2000);
+
+  dip::DIP d;
+  d.add_string("foo int[3] = [1, 2, 1500] m");
+  d.add_string("foo = [1, 2, 3] km");
+  d.add_string("bar int = 2 m");
+  d.add_string("bar = 1999 mm");
+  dip::Environment env = d.parse();
+  EXPECT_EQ(dip::to_value_node(env.nodes.at(0))->value->to_string(), "[1000, 2000, 3000]");
+  EXPECT_EQ(dip::to_value_node(env.nodes.at(1))->value->to_string(), "1");
+  
+}
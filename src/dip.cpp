@@ -2,6 +2,7 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <utility>
 
 #include "dip.h"
 #include "settings.h"
@@ -9,14 +10,13 @@
 
 namespace dip {
 
-  int DIP::num_instances = 0;
+  std::atomic<int> DIP::num_instances = 0;
 
   DIP::DIP() {
     // initial settings
     instance_number = DIP::num_instances++;
-    source.name = "DIP"+std::to_string(instance_number);
-    source.line_number = 0;
-    env.sources.append(source.name,"","",{"",0});
+    source = Source("DIP"+std::to_string(instance_number), 0);
+    env.sources.append(source.name(),"",std::make_shared<const SourceBuffer>(),{});
     
     // populate node lists
     nodes_nohierarchy.insert(nodes_nohierarchy.end(), nodes_special.begin(), nodes_special.end());
@@ -30,7 +30,7 @@ namespace dip {
     // initial settings
     instance_number = DIP::num_instances++;
     source = src;
-    env.sources.append(source.name,"","",{"",0});
+    env.sources.append(source.name(),"",std::make_shared<const SourceBuffer>(),{});
     
     // populate node lists
     nodes_nohierarchy.insert(nodes_nohierarchy.end(), nodes_special.begin(), nodes_special.end());
@@ -43,47 +43,47 @@ namespace dip {
   void DIP::add_string(const std::string& source_code) {
 
     // prepare source data
-    std::string source_file = env.sources.at(source.name).path;
-    std::string source_name = source.name+"_"+std::string(STRING_SOURCE)+std::to_string(num_strings);
+    std::string source_file = std::as_const(env.sources).at(source.name()).path;
+    std::string source_name = source.name()+"_"+std::string(STRING_SOURCE)+std::to_string(num_strings);
     num_strings++;
     
     // create a new source
-    env.sources.append(source_name,source_file,source_code,{source.name, source.line_number});
+    SourceCode code = std::make_shared<const SourceBuffer>(source_code);
+    env.sources.append(source_name,source_file,code,source);
     
     // parse lines from the source code
-    parse_lines(lines, source_code, source_name);
+    parse_lines(lines, code, source_name);
     
   }
 
   void DIP::add_file(const std::string& source_file, std::string source_name, const bool absolute) {
+    add_file(source_file, SourceBuffer::from_file(source_file), source_name);
+  }
+
+  void DIP::add_file(const std::string& source_file, const SourceCode& code, std::string source_name) {
     
     // prepare source data
-    std::ifstream file(source_file);
-    if (!file) 
-      throw std::runtime_error("Following file could not be found: "+source_file);
-    std::ostringstream source_code;
-    source_code << file.rdbuf();
     if (source_name.empty()) {
       // TODO: implement 'absolute' switch
-      source_name = source.name+"_"+std::string(FILE_SOURCE)+std::to_string(num_files);
+      source_name = source.name()+"_"+std::string(FILE_SOURCE)+std::to_string(num_files);
       num_files++;
     }
 
     // create a new source
     // TODO: treat source lineno and source_file with respect to where this method is called 
-    env.sources.append(source_name,source_file,source_code.str(),{source.name, source.line_number});
+    env.sources.append(source_name,source_file,code,source);
 
     // parse lines from the source code
-    parse_lines(lines, source_code.str(), source_name);
+    parse_lines(lines, code, source_name);
     
   }
 
   void DIP::add_source(const std::string& sname, const std::string& spath) {
-    std::string source_name = source.name+"_"+std::string(DIRECT_SOURCE)+std::to_string(num_sources);
+    std::string source_name = source.name()+"_"+std::string(DIRECT_SOURCE)+std::to_string(num_sources);
     num_sources++;
     Source sparent = {source_name, 0};
     EnvSource senv = parse_source(sname, spath, sparent);
-    env.sources.append(sname, senv);
+    env.sources.append(sname, std::move(senv));
   }
   
   void DIP::add_unit(const std::string& name, const double value, const std::string& unit) {
@@ -98,6 +98,24 @@ namespace dip {
     env.functions.append_table(name, func);
   }
   
+  void DIP::set_source_threads(const size_t num_threads) {
+    source_threads = num_threads;
+  }
+
+  void DIP::set_parse_threads(const size_t num_threads) {
+    if (num_threads==0)
+      throw std::runtime_error("Number of parsing threads must be larger than zero");
+    parse_threads = num_threads;
+  }
+
+  void DIP::set_lean(const bool enabled) {
+    lean = enabled;
+  }
+
+  void DIP::set_lazy(const bool enabled) {
+    lazy = enabled;
+  }
+  
   std::string DIP::to_string() {
     return "DIP";
   }
@@ -107,31 +125,48 @@ namespace dip {
     NodeDtype::Boolean,NodeDtype::Integer,NodeDtype::Float,NodeDtype::String,NodeDtype::Table
   };
   
-  Environment DIP::parse() {
-    NodeList queue = parse_code_nodes(lines);
-    // set properties to nodes
+  void DIP::set_properties(BaseNode::NodeListType& queue) {
     BaseNode::PointerType previous_node = nullptr;
     for (size_t i = 0; i < queue.size(); ++i) {
       BaseNode::PointerType current_node = queue.at(i);
       if (current_node->dtype==NodeDtype::Property) {
-	PropertyNode::PointerType pnode = std::dynamic_pointer_cast<PropertyNode>(current_node);
+	PropertyNode::PointerType pnode = std::static_pointer_cast<PropertyNode>(current_node);
+	if (previous_node and previous_node->dtype==NodeDtype::Lazy) {
+	  // properties that were classified separately, e.g. in the next stream chunk, are classified again with their node
+	  std::static_pointer_cast<LazyNode>(previous_node)->lines.push_back(pnode->line);
+	  continue;
+	}
 	if (std::find(preceeding_nodes.begin(), preceeding_nodes.end(), previous_node->dtype) == preceeding_nodes.end())
-	  throw std::runtime_error("Only value nodes (bool, int, float and str) can have properties: "+pnode->line.code);
+	  throw std::runtime_error("Only value nodes (bool, int, float and str) can have properties: "+std::string(pnode->line.code));
 	if (previous_node->indent>=pnode->indent)
 	  throw std::runtime_error("The indent '"+std::to_string(pnode->indent)+"' of a property is not higher than the indent '"+
-				   std::to_string(previous_node->indent)+"' of a preceding node: "+pnode->line.code);
+				   std::to_string(previous_node->indent)+"' of a preceding node: "+std::string(pnode->line.code));
 	if (!previous_node->set_property(pnode->ptype, pnode->value_raw, pnode->units_raw))
-	  throw std::runtime_error("Property could not be set: "+pnode->line.code);
+	  throw std::runtime_error("Property could not be set: "+std::string(pnode->line.code));
       } else {
 	previous_node = current_node;
       }
     }
-    // parse other nodes
-    Environment target = env;
+  }
+
+  void DIP::process_nodes(BaseNode::NodeListType& queue, Environment& target, const NodeCallback* callback) {
     while (queue.size()>0) {
-      BaseNode::PointerType node = queue.pop_front();
+      BaseNode::PointerType node = queue.front();
+      queue.pop_front();
       if (node->dtype==NodeDtype::Property)
 	continue;
+      if (node->dtype==NodeDtype::Lazy and !target.branching.false_case()) {
+	// lines of an active case are classified only now
+	LazyNode::PointerType lnode = std::static_pointer_cast<LazyNode>(node);
+	std::queue<Line> lines(std::deque<Line>(lnode->lines.begin(), lnode->lines.end()));
+	BaseNode::NodeListType parsed = parse_code_nodes(lines);
+	set_properties(parsed);
+	while (parsed.size()>0) {
+	  queue.push_front(parsed.back());
+	  parsed.pop_back();
+	}
+	continue;
+      }
       if (!target.branching.false_case() or node->dtype==NodeDtype::Case) {
 	// Perform specific node parsing only outside of case or inside of valid case
 	BaseNode::NodeListType parsed = node->parse(target);
@@ -155,49 +190,183 @@ namespace dip {
       } else {
 	target.branching.prepare_node(node);
 	// Clean node name from cases
-	node->name = target.branching.clean_name(node->name);
+	PathId path = target.branching.clean_path(node->path);
+	if (path!=node->path) {
+	  node->path = path;
+	  node->name = target.paths->path_name(path);
+	}
 	// Set the node value an unit
 	// TODO: maybe this can be done after modifications?!
-	ValueNode::PointerType vnode = std::dynamic_pointer_cast<ValueNode>(node);
+	ValueNode::PointerType vnode = to_value_node(node);
 	if (vnode and vnode->value==nullptr) {
 	  vnode->set_value();
 	}
-	QuantityNode::PointerType qnode = std::dynamic_pointer_cast<QuantityNode>(node);
+	QuantityNode::PointerType qnode = to_quantity_node(node);
 	if (qnode and qnode->units==nullptr) {
 	  qnode->set_units();
 	}
 	// If node was previously defined, modify its value
-	bool new_node = true;
-	for (size_t i=0; i<target.nodes.size(); i++) {
-	  if (target.nodes.at(i)->name==node->name) {
-	    ValueNode::PointerType pnode = std::dynamic_pointer_cast<ValueNode>(target.nodes.at(i));
-	    pnode->validate_constant();
-	    pnode->modify_value(node, target);
-	    new_node = false;
-	  }
-	}
-	if (new_node) {
+	BaseNode::PointerType previous = target.nodes.find(node->name);
+	if (previous) {
+	  ValueNode::PointerType pnode = to_value_node(previous);
+	  pnode->validate_constant();
+	  pnode->modify_value(node, target);
+	} else {
 	  if (node->dtype==NodeDtype::Modification) {
-	    std::string prefix = source.name+"_"+std::string(STRING_SOURCE);
-	    if (node->line.source.name.compare(0, prefix.size(), prefix) == 0)
-	      throw std::runtime_error("Modifying undefined node: "+node->line.code);
+	    // emitted nodes are not kept in the streaming mode and cannot be modified
+	    std::string prefix = source.name()+"_"+std::string(STRING_SOURCE);
+	    if (callback or node->line.source.name().compare(0, prefix.size(), prefix) == 0)
+	      throw std::runtime_error("Modifying undefined node: "+std::string(node->line.code));
+	  }
+	  if (callback) {
+	    validate_node(node);
+	    if (lean)
+	      node->release_raw();
+	    (*callback)(node);
+	  } else {
+	    target.nodes.push_back(node);
 	  }
-	  target.nodes.push_back(node);
 	}
       }      
     }
+  }
+
+  void DIP::validate_node(BaseNode::PointerType node) {
+    ValueNode::PointerType vnode = to_value_node(node);
+    if (vnode) {
+      vnode->validate_definition();
+      vnode->validate_options();
+      vnode->validate_condition();
+      vnode->validate_format();
+    } else {
+      throw std::runtime_error("Detected non-value node in the node list: "+std::string(node->line.code));
+    }
+  }
+  
+  Environment DIP::parse() {
+    // lines are kept, so that the code can be parsed again after adding new code
+    std::queue<Line> code_lines = lines;
+    BaseNode::NodeListType queue = parse_code_nodes(code_lines, parse_threads, lazy);
+    // set properties to nodes
+    set_properties(queue);
+    // parse independent sources in advance; they are added to the environment in the order of declaration.
+    // Sources inside of case branches are parsed only when their case is reached, because it may be inactive
+    SourcePrefetch prefetch;
+    if (source_threads>0) {
+      std::vector<size_t> branches;   // indents of the open case branches
+      for (auto node: queue) {
+	if (node->dtype==NodeDtype::Property)
+	  continue;
+	if (node->dtype==NodeDtype::Case) {
+	  while (!branches.empty() and branches.back()>node->indent)
+	    branches.pop_back();
+	  if (node->line.code.substr(node->indent+1).starts_with(KEYWORD_END)) {
+	    if (!branches.empty() and branches.back()==node->indent)
+	      branches.pop_back();
+	  } else if (branches.empty() or branches.back()<node->indent) {
+	    branches.push_back(node->indent);
+	  }
+	  continue;
+	}
+	// only a lower indent closes a branch here; skipping too many sources is harmless
+	while (!branches.empty() and branches.back()>node->indent)
+	  branches.pop_back();
+	if (node->dtype==NodeDtype::Source and branches.empty()) {
+	  SourceNode::PointerType snode = std::static_pointer_cast<SourceNode>(node);
+	  snode->prefetched = prefetch.add(snode->value_raw.at(0), snode->value_raw.at(1), snode->line.source);
+	}
+      }
+      prefetch.start(source_threads);
+    }
+    // parse other nodes; sources and functions are shared with the DIP environment
+    Environment target = env;
+    process_nodes(queue, target);
     // Validate nodes
     for (ssize_t i=0; i<target.nodes.size(); i++) {
-      ValueNode::PointerType vnode = std::dynamic_pointer_cast<ValueNode>(target.nodes.at(i));
-      if (vnode) {
-	vnode->validate_definition();
-	vnode->validate_options();
-	vnode->validate_condition();
-	vnode->validate_format();
-      } else {
-	throw std::runtime_error("Detected non-value node in the node list: "+target.nodes.at(i)->line.code);
+      validate_node(target.nodes.at(i));
+    }
+    // raw strings are not needed after validation
+    if (lean) {
+      for (ssize_t i=0; i<target.nodes.size(); i++)
+	target.nodes.at(i)->release_raw();
+      target.sources.release();
+    }
+    return target;
+  }
+
+  Environment DIP::parse_stream(std::istream& stream, const NodeCallback& callback, const size_t chunk_size) {
+    if (chunk_size==0)
+      throw std::runtime_error("Stream chunk size must be larger than zero");
+    if (source_threads>0)
+      throw std::runtime_error("Sources cannot be parsed in advance in the streaming mode");
+    // register a new source; its code is not kept, because it is read only by chunks
+    std::string source_name = source.name()+"_"+std::string(STREAM_SOURCE)+std::to_string(num_streams);
+    num_streams++;
+    env.sources.append(source_name,"",std::make_shared<const SourceBuffer>(),source);
+
+    // nodes given by add_string and add_file are parsed before the stream
+    Environment target = env;
+    std::queue<Line> code_lines = lines;
+    BaseNode::NodeListType pending = parse_code_nodes(code_lines, parse_threads, lazy);
+    
+    std::string chunk(chunk_size, '\0');
+    std::string rest;                 // incomplete last line of a chunk
+    std::queue<Line> chunk_lines;     // lines that were not yet converted to nodes
+    std::queue<Line> block_lines;     // complete lines, possibly ending with an unclosed block string
+    int line_number = 0;
+    bool in_block = false;
+    while (true) {
+      stream.read(chunk.data(), chunk_size);
+      size_t num_read = stream.gcount();
+      bool finished = (num_read==0);
+      if (!finished) {
+	// only complete lines are parsed, the rest is kept for the next chunk
+	rest.append(chunk.data(), num_read);
+	size_t end = rest.rfind(SEPARATOR_NEWLINE);
+	if (end==std::string::npos)
+	  continue;
+	SourceCode code = std::make_shared<const SourceBuffer>(rest.substr(0, end+1));
+	rest.erase(0, end+1);
+	parse_lines(chunk_lines, code, source_name, line_number);
+	line_number += std::count(code->data(), code->data()+code->size(), SEPARATOR_NEWLINE);
+      } else if (!rest.empty()) {
+	parse_lines(chunk_lines, rest, source_name, line_number);
+	rest.clear();
+      }
+      // lines of a block string have to be converted into a node together
+      while (!chunk_lines.empty()) {
+	Line line = chunk_lines.front();
+	chunk_lines.pop();
+	size_t pos = line.code.find(SIGN_BLOCK);
+	if (in_block)
+	  in_block = (pos==std::string_view::npos);
+	else if (pos!=std::string_view::npos)
+	  in_block = (line.code.find(SIGN_BLOCK, pos+SIGN_BLOCK.length())==std::string_view::npos);
+	block_lines.push(line);
+      }
+      // lines are converted into nodes together, unless they end in an unclosed block string
+      if (!in_block or finished) {
+	BaseNode::NodeListType nodes = parse_code_nodes(block_lines, parse_threads, lazy);
+	for (auto node: nodes)
+	  pending.push_back(node);
+      }
+      // the last node may still receive properties from the next chunk
+      size_t num_ready = pending.size();
+      if (!finished) {
+	while (num_ready>0 and pending.at(num_ready-1)->dtype==NodeDtype::Property)
+	  num_ready--;
+	if (num_ready>0)
+	  num_ready--;
       }
+      BaseNode::NodeListType queue(pending.begin(), pending.begin()+num_ready);
+      pending.erase(pending.begin(), pending.begin()+num_ready);
+      set_properties(queue);
+      process_nodes(queue, target, &callback);
+      if (finished)
+	break;
     }
+    if (lean)
+      target.sources.release();
     return target;
   }
 
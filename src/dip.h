@@ -4,14 +4,18 @@
 #include <iostream>
 #include <queue>
 #include <array>
+#include <functional>
+#include <atomic>
 
 #include "environment.h"
 
 namespace dip {
 
   class DIP {
+  public:
+    typedef std::function<void(BaseNode::PointerType)> NodeCallback;
   private:
-    static int num_instances;
+    static std::atomic<int> num_instances;
     int instance_number;
     Environment env;
     std::queue<Line> lines;
@@ -34,17 +38,47 @@ namespace dip {
     size_t num_files = 0;   // counter of code inputs from a file
     size_t num_sources = 0; // number of explicitely added sources
     size_t num_units = 0;   // number of explicitely added units
+    size_t num_streams = 0; // number of parsed input streams
+    size_t source_threads = 0; // number of threads parsing sources in advance
+    size_t parse_threads = 1;  // number of threads converting code lines into nodes
+    bool lean = false;         // release raw strings and source code after parsing
+    bool lazy = false;         // convert lines of case branches into nodes only if their case is active
+
+    void set_properties(BaseNode::NodeListType& queue);
+    void process_nodes(BaseNode::NodeListType& queue, Environment& target, const NodeCallback* callback=nullptr);
+    static void validate_node(BaseNode::PointerType node);
     
   public:
     DIP();
     DIP(const Source& src);
     void add_string(const std::string& source_code);
+    // Large regular files are memory-mapped (see MIN_MAPPED_SIZE) and their lines point into the mapping
+    // for as long as the returned environments keep the nodes; such files must not be truncated meanwhile.
     void add_file(const std::string& source_file, std::string source_name="", const bool absolute=true);
+    // Add code of a file that was already read
+    void add_file(const std::string& source_file, const SourceCode& code, std::string source_name="");
     void add_source(const std::string& source_name, const std::string& source_file);
     void add_unit(const std::string& name, const double value, const std::string& unit="");    
     void add_value_function(const std::string& name, FunctionList::ValueFunctionType func);
     void add_node_function(const std::string& name, FunctionList::TableFunctionType func);
+    // Parse all $source declarations concurrently before the other nodes; 0 parses sources sequentially
+    void set_source_threads(const size_t num_threads);
+    // Convert code lines into nodes on multiple threads; the resulting nodes are the same as with one thread
+    void set_parse_threads(const size_t num_threads);
+    // Release raw value strings and source code of the parsed nodes; errors then refer only to source names and line numbers.
+    // Sources of the returned environment keep neither code nor nodes, so they cannot be referenced from it anymore.
+    // The DIP itself and the source cache (see clear_source_cache) still keep the sources they hold.
+    void set_lean(const bool enabled);
+    // Lines of inactive case branches are only scanned for their indent and name; their syntax is then not validated
+    void set_lazy(const bool enabled);
+    // Collected code lines are not consumed, so every call parses all code added so far and
+    // the DIP keeps the buffers of its sources alive; new code can be added between the calls
     Environment parse();
+    // Parse code from a stream in chunks and pass every finished value node to the callback.
+    // Emitted nodes are not stored in the returned environment, therefore they cannot be
+    // modified or referenced locally by the following code. Parse threads, lazy and lean modes
+    // apply to the stream as well; sources cannot be parsed in advance.
+    Environment parse_stream(std::istream& stream, const NodeCallback& callback, const size_t chunk_size=65536);
     Environment parse_docs();
     std::string to_string();
   };
@@ -10,12 +10,19 @@ namespace dip {
       return {request.substr(0, pos), request.substr(pos + 1)};
   }
   
-  Environment::Environment() {
+  Environment::Environment(): paths(std::make_shared<PathTable>()), nodes(paths), hierarchy(paths), branching(paths) {
     
   }
 
-  std::string Environment::request_code(const std::string& source_name) const {
-    return sources.at(source_name).code;
+  NodeTable Environment::table() const {
+    return NodeTable(nodes);
+  }
+
+  SourceCode Environment::request_code(const std::string& source_name) const {
+    SourceCode code = sources.at(source_name).code;
+    if (code==nullptr)
+      throw std::runtime_error("Code of the following source was released: "+source_name);
+    return code;
   }
   
   BaseValue::PointerType Environment::request_value(const std::string& request, const RequestType rtype, const std::string& to_unit) const {
@@ -29,23 +36,21 @@ namespace dip {
     case RequestType::Reference: {
       auto [source_name, node_path] = parse_request(request);
       const NodeList& node_pool = (source_name.empty()) ? nodes : sources.at(source_name).nodes;
-       for (size_t i=0; i<node_pool.size(); i++) {
-	 BaseNode::PointerType node = node_pool.at(i);
-	 ValueNode::PointerType vnode = std::dynamic_pointer_cast<ValueNode>(node);
-	 if (vnode and vnode->name==node_path) {
-	   new_value = vnode->value->clone();
-	   QuantityNode::PointerType qnode = std::dynamic_pointer_cast<QuantityNode>(node);
-	   if (qnode) {
-	     if (qnode->units==nullptr and !to_unit.empty()) 
-	       throw std::runtime_error("Trying to convert nondimensional quantity into '"+qnode->units_raw+"': "+qnode->line.code);
-	     else if (qnode->units!=nullptr and to_unit.empty())
-	       throw std::runtime_error("Trying to convert '"+qnode->units_raw+"' into a nondimensional quantity: "+qnode->line.code);
-	     else if (qnode->units!=nullptr)
-	       new_value->convert_units(qnode->units, to_unit);
-	   }
-	 }
-       }
-       break;
+      BaseNode::PointerType node = node_pool.find(node_path);
+      ValueNode::PointerType vnode = to_value_node(node);
+      if (vnode) {
+	new_value = vnode->value->clone();
+	QuantityNode::PointerType qnode = to_quantity_node(node);
+	if (qnode) {
+	  if (qnode->units==nullptr and !to_unit.empty()) 
+	    throw std::runtime_error("Trying to convert nondimensional quantity into '"+qnode->units_raw+"': "+qnode->line.code_or_location());
+	  else if (qnode->units!=nullptr and to_unit.empty())
+	    throw std::runtime_error("Trying to convert '"+qnode->units_raw+"' into a nondimensional quantity: "+qnode->line.code_or_location());
+	  else if (qnode->units!=nullptr)
+	    units.convert_units(*new_value, qnode->units_raw, to_unit);
+	}
+      }
+      break;
     }
     default:
       throw std::runtime_error("Unrecognized environment request type");
@@ -68,9 +73,9 @@ namespace dip {
       if (!node_path.empty())
 	node_path += std::string(1,SIGN_SEPARATOR);
       const NodeList& node_pool = (source_name.empty()) ? nodes : sources.at(source_name).nodes;
-      for (size_t i=0; i<node_pool.size(); i++) {
-	ValueNode::PointerType vnode = std::dynamic_pointer_cast<ValueNode>(node_pool.at(i));
-	if (vnode and vnode->name.rfind(node_path, 0) == 0 and vnode->name.size()>node_path.size()) {
+      for (auto node: node_pool.find_prefix(node_path)) {
+	ValueNode::PointerType vnode = to_value_node(node);
+	if (vnode and vnode->name.size()>node_path.size()) {
 	  std::string new_name = vnode->name.substr(node_path.size(), vnode->name.size());
 	  new_nodes.push_back(vnode->clone(new_name));
 	}
@@ -10,8 +10,8 @@ namespace dip {
   };
   
   class Environment {
-  private:
   public:
+    std::shared_ptr<PathTable> paths;  // interned node names shared by the node, hierarchy and branching lists
     SourceList sources;
     UnitList units;
     NodeList nodes;
@@ -19,7 +19,10 @@ namespace dip {
     BranchingList branching;
     FunctionList functions;
     Environment();
-    std::string request_code(const std::string& source_name) const;
+    // Read-only copy of the current value nodes; it is built on every call and
+    // does not reflect later changes of the nodes
+    NodeTable table() const;
+    SourceCode request_code(const std::string& source_name) const;
     BaseValue::PointerType request_value(const std::string& request, const RequestType rtype, const std::string& to_unit="") const;
     BaseNode::NodeListType request_nodes(const std::string& request, const RequestType rtype) const;
   };
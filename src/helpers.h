@@ -9,6 +9,15 @@ namespace dip {
     auto end = std::find_if_not(str.rbegin(), str.rend(), ::isspace).base();
     str = (start < end) ? std::string(start, end) : "";
   }
+  inline void trim(std::string_view& str) {
+    size_t start = 0;
+    while (start<str.size() and ::isspace(static_cast<unsigned char>(str[start])))
+      start++;
+    size_t end = str.size();
+    while (end>start and ::isspace(static_cast<unsigned char>(str[end-1])))
+      end--;
+    str = str.substr(start, end-start);
+  }
 
   // concatenate multiple strings at the compile time
   // this is used to compose regular expression patterns
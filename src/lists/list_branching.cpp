@@ -1,9 +1,15 @@
-#include <regex>
+#include <algorithm>
 
 #include "lists.h"
 
 namespace dip {
 
+  // Case markers are name segments created from case nodes, e.g. '@C3'
+  inline bool is_case_marker(std::string_view segment) {
+    return segment.size()>2 and segment[0]==SIGN_CONDITION and segment[1]=='C' and
+      std::all_of(segment.begin()+2, segment.end(), [](char c){return std::isdigit(static_cast<unsigned char>(c));});
+  }
+
   // Get ID of a current branch
   size_t BranchingList::get_branch_id() {
     if (state.size()>0) {
@@ -29,6 +35,8 @@ namespace dip {
   int BranchingList::open_branch(const size_t case_id) {
     size_t branch_id = ++num_branches;
     state.push_back(branch_id);
+    if (branches.size()<=branch_id)
+      branches.resize(branch_id+1);
     branches[branch_id] = Branch({case_id}, {CaseType::Case});
     return 0;
   }
@@ -48,6 +56,19 @@ namespace dip {
       throw std::runtime_error("No more branches to be closed");
     else
       state.pop_back();
+    update_state();
+  }
+
+  // Cache whether nodes of the current case should be skipped
+  void BranchingList::update_state() {
+    if (state.empty()) {
+      inactive = false;
+      return;
+    }
+    Branch& branch = branches.at(get_branch_id());
+    const Case& cs = cases.at(get_case_id());
+    // the current case is active only if it is the first true case in a branch
+    inactive = (branch.num_true!=1 or !cs.value);
   }
 
   // Add a new case
@@ -57,35 +78,18 @@ namespace dip {
 
   // Checks if case value is false
   bool BranchingList::false_case() {
-    if (state.empty())
-      return false;
-    size_t branch_id = get_branch_id();
-    Branch& branch = branches.at(branch_id);
-    int num_true = 0;
-    // count number of cases with a true value in the current branch
-    for (size_t case_id: branch.cases) {
-      Case& cs = cases.at(case_id);
-      if (cs.value==true)
-	num_true++;
-    }
-    // get the value of the current case
-    size_t case_id = get_case_id();
-    Case& cs = cases.at(case_id);
-    // the current case is false if this is the first true case in a branch
-    return (num_true!=1 or !cs.value);
+    return inactive;
   }
 
   // Manage condition nodes
   void BranchingList::solve_case(BaseNode::PointerType node) {
-    std::ostringstream oss;
-    oss << "(.*[" << SIGN_CONDITION << "])C([0-9]+)";
-    std::regex pattern(oss.str());
-    std::smatch matchResult;
-    if (std::regex_search(node->name, matchResult, pattern)) {
-      std::shared_ptr<CaseNode> cnode = std::dynamic_pointer_cast<CaseNode>(node);
-      if (cnode==nullptr)
-	throw std::runtime_error("Given node must be a case node:  "+node->line.code);
-      std::string path_new = matchResult[1].str();
+    // case node names end with a case marker, e.g. 'foo.@C3'
+    size_t pos = node->name.rfind(SIGN_CONDITION);
+    if (pos!=std::string::npos and is_case_marker(std::string_view(node->name).substr(pos))) {
+      if (node->dtype!=NodeDtype::Case)
+	throw std::runtime_error("Given node must be a case node:  "+std::string(node->line.code));
+      std::shared_ptr<CaseNode> cnode = std::static_pointer_cast<CaseNode>(node);
+      std::string path_new = node->name.substr(0, pos+1);
       std::string path_old;
       if (!state.empty()) {
 	size_t case_id = get_case_id();
@@ -102,11 +106,11 @@ namespace dip {
 	return;
       } else {
 	std::cout << cases.size() << " " << path_old << " " << path_new << std::endl;
-	throw std::runtime_error("Invalid condition type:  "+node->line.code);
+	throw std::runtime_error("Invalid condition type:  "+std::string(node->line.code));
       }
       // determine branch part and ID
       size_t branch_part;
-      size_t case_id = std::stoull(matchResult[2].str()); 
+      size_t case_id = std::stoull(node->name.substr(pos+2));
       if (path_new==path_old) {
 	branch_part = switch_case(case_id, cnode->case_type);
       } else if (path_new.size()<path_old.size()) {
@@ -137,16 +141,22 @@ namespace dip {
 	size_t parent_branch_id = state[state.size()-2];
 	size_t parent_case_id = get_case_id(parent_branch_id);
 	Case& cs = cases.at(parent_case_id);
-	case_value &= cs.value;
+	// parent case is active only if it is the first true case of its branch
+	case_value &= (cs.value and branches.at(parent_branch_id).num_true==1);
 	// std::cout << " " << case_value << " " << parent_branch_id << parent_case_id;
       }
       // std::cout << std::endl;
       // register new case
       std::string expr = (cnode->value_raw.empty()) ? "" : cnode->value_raw.at(0);
-      cases[case_id] = Case(path_new, cnode->line.code, expr, case_value,
+      if (cases.size()<=case_id)
+	cases.resize(case_id+1);
+      cases[case_id] = Case(path_new, std::string(cnode->line.code), expr, case_value,
 			    branch_id, branch_part, case_id, cnode->case_type);
+      if (case_value)
+	branches.at(branch_id).num_true++;
+      update_state();
     } else {
-      throw std::runtime_error("Invalid condition format: "+node->line.code);
+      throw std::runtime_error("Invalid condition format: "+std::string(node->line.code));
     }
   }
 
@@ -165,22 +175,67 @@ namespace dip {
       size_t branch_id = get_branch_id();
       node->branch_id = branch_id;
       node->case_id = get_case_id();
-      std::string node_name = clean_name(node->name);
+      PathId node_path = clean_path(node->path);
       Branch& branch = branches.at(branch_id);
-      auto it = branch.nodes.find(node_name);
+      auto it = branch.nodes.find(node_path);
       if (it == branch.nodes.end()) {
-	branch.nodes[node_name] = 1;
+	branch.nodes[node_path] = 1;
       } else {
-	branch.nodes[node_name]++;
+	branch.nodes[node_path]++;
       }
     }
   }
 
+  // End of a case marker '@C<n>' and the character following it, as matched by '@C[0-9]+.'
+  inline size_t case_marker_end(std::string_view name, const size_t pos) {
+    if (name.size()<pos+3 or name[pos]!=SIGN_CONDITION or name[pos+1]!='C')
+      return pos;
+    size_t end = pos+2;
+    while (end<name.size() and std::isdigit(static_cast<unsigned char>(name[end])))
+      end++;
+    if (end==pos+2)
+      return pos;
+    if (end<name.size())
+      return end+1;
+    // the last digit of a marker at the end of a name is taken as the following character
+    return (end-pos>3) ? end : pos;
+  }
+
+  // Remove case markers together with the character following them, usually a separator, from a name
   std::string BranchingList::clean_name(const std::string& name) {
-    std::ostringstream oss;
-    oss << "(" << SIGN_CONDITION << "C[0-9]+" << SIGN_SEPARATOR << ")";
-    std::regex pattern(oss.str());
-    return std::regex_replace(name, pattern, "");
+    std::string cleaned;
+    cleaned.reserve(name.size());
+    size_t pos = 0;
+    while (pos<name.size()) {
+      size_t end = case_marker_end(name, pos);
+      if (end>pos)
+	pos = end;
+      else
+	cleaned.push_back(name[pos++]);
+    }
+    return cleaned;
+  }
+
+  // Remove case markers from a path, as in clean_name
+  PathId BranchingList::clean_path(const PathId path) {
+    std::vector<SymbolId> symbols = paths->path_symbols(path);
+    size_t num_cases = 0;
+    for (size_t i=0; i<symbols.size(); i++) {
+      const std::string& symbol = paths->symbol_name(symbols[i]);
+      if (symbol.find(SIGN_CONDITION)==std::string::npos)
+	continue;
+      if (i+1<symbols.size() and is_case_marker(symbol))
+	num_cases++;
+      else // markers within a segment, e.g. 'foo@C3', are not whole symbols
+	return paths->intern(0, clean_name(paths->path_name(path)));
+    }
+    if (num_cases==0)
+      return path;
+    std::vector<SymbolId> cleaned;
+    for (size_t i=0; i<symbols.size(); i++)
+      if (i+1==symbols.size() or !is_case_marker(paths->symbol_name(symbols[i])))
+	cleaned.push_back(symbols[i]);
+    return paths->intern(0, cleaned);
   }
   
 }
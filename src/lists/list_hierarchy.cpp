@@ -1,10 +1,118 @@
-#include <sstream>
-#include <iostream>
+#include <algorithm>
 
 #include "lists.h"
 
 namespace dip {
 
+  /*
+   * Path table
+   */
+
+  std::atomic<uint64_t> PathTable::num_tables = 0;
+  
+  PathTable::PathTable(): table_id(++num_tables), paths({{0, 0, ""}}), symbols({""}) {
+    symbol_ids.emplace(symbols.front(), 0);
+    path_ids.emplace(paths.front().name, 0);
+  }
+  
+  // table has to be locked for writing
+  PathId PathTable::intern_child(const PathId parent, const SymbolId symbol) {
+    uint64_t key = (static_cast<uint64_t>(parent) << 32) | symbol;
+    auto it = children.find(key);
+    if (it!=children.end())
+      return it->second;
+    PathId id = paths.size();
+    if (parent==0)
+      paths.push_back({parent, symbol, symbols[symbol]});
+    else
+      paths.push_back({parent, symbol, paths[parent].name+SIGN_SEPARATOR+symbols[symbol]});
+    children.emplace(key, id);
+    path_ids.emplace(paths.back().name, id);
+    return id;
+  }
+  
+  PathId PathTable::intern(const PathId parent, std::string_view name) {
+    if (name.empty())
+      return parent;
+    {
+      // names that were already interned are found with a shared lock
+      std::shared_lock<std::shared_mutex> lock(mutex);
+      if (parent==0) {
+	auto it = path_ids.find(name);
+	if (it!=path_ids.end())
+	  return it->second;
+      } else {
+	auto it = symbol_ids.find(name);
+	if (it!=symbol_ids.end()) {
+	  auto ic = children.find((static_cast<uint64_t>(parent) << 32) | it->second);
+	  if (ic!=children.end())
+	    return ic->second;
+	}
+      }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (parent>=paths.size())
+      throw std::runtime_error("Unknown parent path ID: "+std::to_string(parent));
+    PathId id = parent;
+    size_t begin = 0;
+    while (begin<=name.size()) {
+      size_t end = name.find(SIGN_SEPARATOR, begin);
+      if (end==std::string_view::npos)
+	end = name.size();
+      std::string_view segment = name.substr(begin, end-begin);
+      auto it = symbol_ids.find(segment);
+      SymbolId symbol;
+      if (it!=symbol_ids.end()) {
+	symbol = it->second;
+      } else {
+	symbol = symbols.size();
+	symbols.emplace_back(segment);
+	symbol_ids.emplace(symbols.back(), symbol);
+      }
+      id = intern_child(id, symbol);
+      begin = end+1;
+    }
+    return id;
+  }
+
+  PathId PathTable::intern(const PathId parent, const std::vector<SymbolId>& path_symbols) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    PathId id = parent;
+    for (SymbolId symbol: path_symbols)
+      id = intern_child(id, symbol);
+    return id;
+  }
+
+  PathId PathTable::find(std::string_view name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = path_ids.find(name);
+    return (it==path_ids.end()) ? 0 : it->second;
+  }
+
+  // Symbols of a path ordered from the root
+  std::vector<SymbolId> PathTable::path_symbols(const PathId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::vector<SymbolId> path_symbols;
+    for (PathId i=id; i!=0; i=paths.at(i).parent)
+      path_symbols.push_back(paths[i].symbol);
+    std::reverse(path_symbols.begin(), path_symbols.end());
+    return path_symbols;
+  }
+  
+  const std::string& PathTable::path_name(const PathId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return paths.at(id).name;
+  }
+
+  const std::string& PathTable::symbol_name(const SymbolId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return symbols.at(id);
+  }
+  
+  /*
+   * Hierarchy list
+   */
+  
   void HierarchyList::record(BaseNode::PointerType node, const std::vector<NodeDtype>& excluded) {
     if (node->name=="")
       return;
@@ -16,16 +124,14 @@ namespace dip {
     while (parents.size()>0 and node->indent<=parents.back().indent) {
       parents.pop_back();
     }
-    parents.push_back({node->indent, node->name});
     
     // set node name according to the hierarchy
-    if (parents.size()>1) {
-      std::stringstream ss;    
-      for (auto parent: parents)
-	ss << parent.name << SIGN_SEPARATOR;
-      node->name = ss.str();
-      node->name = node->name.substr(0, node->name.size()-1);
-    }
+    PathId path = paths->intern(parents.empty() ? 0 : parents.back().path, node->name);
+    parents.push_back({node->indent, path});
+    if (parents.size()>1)
+      node->name = paths->path_name(path);
+    node->path = path;
+    node->path_table = paths->id();
   }
   
 }
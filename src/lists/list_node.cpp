@@ -1,31 +1,83 @@
+#include <algorithm>
+
 #include "lists.h"
 
 namespace dip {
 
+  NodeList::NodeList(const BaseNode::NodeListType& nl) {
+    for (auto node: nl)
+      push_back(node);
+  }
+
+  // Interned name of a node; names are interned again when the node comes from a list with another path table
+  PathId NodeList::node_path(const BaseNode::PointerType& node) const {
+    if (node->path==0 or node->path_table!=paths->id()) {
+      node->path = paths->intern(0, node->name);
+      node->path_table = paths->id();
+    }
+    return node->path;
+  }
+  
   size_t NodeList::size() const {
     return nodes.size();
   }
+
+  NodeList::IndexEntry& NodeList::insert(const BaseNode::PointerType& node, const long long position) {
+    if (paths==nullptr)
+      paths = std::make_shared<PathTable>();
+    PathId path = node_path(node);
+    auto [it, inserted] = index.try_emplace(path, IndexEntry({position, 0}));
+    if (inserted)
+      sorted.emplace(paths->path_name(path), path);
+    it->second.count++;
+    return it->second;
+  }
     
   void NodeList::push_front(BaseNode::PointerType node) {
     nodes.push_front(node);
+    offset--;
+    // nodes with the same name that are already in the list have higher positions
+    insert(node, offset);
   }
   
   void NodeList::push_back(BaseNode::PointerType node) {
     nodes.push_back(node);
+    insert(node, offset + nodes.size() - 1).position = offset + nodes.size() - 1;
   }
   
   BaseNode::PointerType NodeList::pop_front() {
     BaseNode::PointerType node = nodes.front();
     nodes.pop_front();
+    unindex(node, offset++);
     return node;
   }
   
   BaseNode::PointerType NodeList::pop_back() {
     BaseNode::PointerType node = nodes.back();
     nodes.pop_back();
+    unindex(node, offset + nodes.size());
     return node;
   }
   
+  void NodeList::unindex(const BaseNode::PointerType& node, const long long position) {
+    PathId path = node_path(node);
+    auto it = index.find(path);
+    if (it==index.end())
+      return;
+    if (--it->second.count==0) {
+      sorted.erase(paths->path_name(path));
+      index.erase(it);
+    } else if (it->second.position==position) {
+      // the removed node was the last one with its name, so the previous one has to be found
+      for (size_t i=nodes.size(); i>0; i--) {
+	if (node_path(nodes[i-1])==path) {
+	  it->second.position = offset + i - 1;
+	  break;
+	}
+      }
+    }
+  }
+  
   BaseNode::PointerType NodeList::at(const size_t index) {
     return nodes.at(index);
   }
@@ -33,5 +85,37 @@ namespace dip {
   BaseNode::PointerType NodeList::at(const size_t index) const {
     return nodes.at(index);
   }
+
+  BaseNode::PointerType NodeList::find(const std::string& name) const {
+    PathId path = (paths==nullptr) ? 0 : paths->find(name);
+    if (path==0)
+      return nullptr;
+    auto it = index.find(path);
+    if (it==index.end())
+      return nullptr;
+    return nodes.at(it->second.position - offset);
+  }
+
+  // Return all nodes whose names start with the prefix, in the order of the list
+  BaseNode::NodeListType NodeList::find_prefix(const std::string& prefix) const {
+    if (prefix.empty())
+      return nodes;
+    std::vector<size_t> positions;
+    for (auto it = sorted.lower_bound(prefix); it!=sorted.end() and it->first.starts_with(prefix); it++) {
+      const IndexEntry& entry = index.at(it->second);
+      if (entry.count==1) {
+	positions.push_back(entry.position - offset);
+      } else {
+	for (size_t i=0; i<nodes.size(); i++)
+	  if (node_path(nodes[i])==it->second)
+	    positions.push_back(i);
+      }
+    }
+    std::sort(positions.begin(), positions.end());
+    BaseNode::NodeListType found;
+    for (size_t position: positions)
+      found.push_back(nodes[position]);
+    return found;
+  }
   
 }
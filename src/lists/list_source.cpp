@@ -1,31 +1,117 @@
 #include <stdexcept>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DIP_MMAP_SOURCES
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include "lists.h"
 #include "../environment.h"
 
 namespace dip {
 
+  /*
+   * Source buffers
+   */
+
+  SourceBuffer::SourceBuffer(std::string c): text(std::move(c)), mapping(nullptr), mapping_size(0) {
+    code = text;
+  }
+
+  SourceBuffer::SourceBuffer(void* addr, const size_t size): mapping(addr), mapping_size(size) {
+    code = std::string_view(static_cast<const char*>(mapping), mapping_size);
+  }
+
+  SourceBuffer::~SourceBuffer() {
+#ifdef DIP_MMAP_SOURCES
+    if (mapping!=nullptr)
+      ::munmap(mapping, mapping_size);
+#endif
+  }
+
+  // Regular files of at least MIN_MAPPED_SIZE bytes are mapped into memory and their pages are loaded
+  // only when lines are parsed. Pipes, small files and files that cannot be mapped are read into memory
+  // in chunks. A mapped file must not be truncated while its nodes are still in use, because reading
+  // the truncated pages raises SIGBUS.
+  SourceCode SourceBuffer::from_file(const std::string& path) {
+#ifdef DIP_MMAP_SOURCES
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd<0)
+      throw std::runtime_error("Following file could not be found: "+path);
+    struct stat st;
+    if (::fstat(fd, &st)==0 and S_ISREG(st.st_mode) and st.st_size>=static_cast<off_t>(MIN_MAPPED_SIZE)) {
+      void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr!=MAP_FAILED) {
+	::close(fd);
+	::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+	return SourceCode(new SourceBuffer(addr, st.st_size));
+      }
+    }
+    std::string text;
+    char chunk[65536];
+    while (true) {
+      ssize_t num_read = ::read(fd, chunk, sizeof(chunk));
+      if (num_read>0)
+	text.append(chunk, num_read);
+      else if (num_read<0 and errno==EINTR)
+	continue;
+      else if (num_read<0) {
+	::close(fd);
+	throw std::runtime_error("Following file could not be read: "+path);
+      } else
+	break;
+    }
+    ::close(fd);
+    return std::make_shared<const SourceBuffer>(std::move(text));
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) 
+      throw std::runtime_error("Following file could not be found: "+path);
+    std::ostringstream text;
+    text << file.rdbuf();
+    return std::make_shared<const SourceBuffer>(text.str());
+#endif
+  }
+
+  /*
+   * Source list
+   */
+
   SourceList::SourceList() {
   }
 
-  void SourceList::append(const std::string& name, const std::string& path, const std::string& code, const Source& parent) {
+  void SourceList::append(const std::string& name, const std::string& path, const SourceCode& code, const Source& parent) {
+    if (sources.contains(name))
+      throw std::invalid_argument("Source with the same name already exists: "+name);
+    sources.insert({name, std::make_shared<EnvSource>(EnvSource({name, path, code, parent}))});
+  }
+
+  void SourceList::append(const std::string& name, EnvSource src) {
     if (sources.contains(name))
       throw std::invalid_argument("Source with the same name already exists: "+name);
-    sources.insert({name, {name, path, code, parent}});
+    sources.insert({name, std::make_shared<EnvSource>(std::move(src))});
   }
 
-  void SourceList::append(const std::string& name, const EnvSource& src) {
+  // Source is shared with the caller until one of them modifies it
+  void SourceList::append(const std::string& name, std::shared_ptr<EnvSource> src) {
     if (sources.contains(name))
       throw std::invalid_argument("Source with the same name already exists: "+name);
-    sources.insert({name, src});
+    sources.insert({name, std::move(src)});
   }
 
   EnvSource& SourceList::at(const std::string& name) {
     auto it = sources.find(name);
     if (it==sources.end())
       throw std::runtime_error("Following source was not found in the environment source list: "+name);
-    else
-      return it->second;
+    // source is shared with another copy of the list and has to be detached before it is modified
+    if (it->second.use_count()>1)
+      it->second = std::make_shared<EnvSource>(*it->second);
+    return *it->second;
   }
   
   const EnvSource& SourceList::at(const std::string& name) const {
@@ -33,7 +119,24 @@ namespace dip {
     if (it==sources.end())
       throw std::runtime_error("Following source was not found in the environment source list: "+name);
     else
-      return it->second;
+      return *it->second;
+  }
+
+  std::vector<SourceDependency> SourceList::dependencies() const {
+    std::vector<SourceDependency> files;
+    for (const auto& [name, src]: sources)
+      files.insert(files.end(), src->dependencies.begin(), src->dependencies.end());
+    return files;
+  }
+
+  // Release the code and parsed nodes of all sources; shared sources are replaced, so that
+  // other lists and the source cache keep theirs
+  void SourceList::release() {
+    for (auto& [name, src]: sources) {
+      if (src->code!=nullptr or src->nodes.size()>0) {
+	src = std::make_shared<EnvSource>(EnvSource({src->name, src->path, nullptr, src->parent, NodeList(), src->dependencies}));
+      }
+    }
   }
   
 }
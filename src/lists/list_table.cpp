@@ -0,0 +1,119 @@
+#include "lists.h"
+
+namespace dip {
+
+  // value pools are indexed by the C++ type corresponding to the node data type
+  const std::type_info& NodeTable::value_type(const ValueDtype dtype) {
+    switch (dtype) {
+    case ValueDtype::Boolean:     return typeid(uint8_t);
+    case ValueDtype::Integer16:   return typeid(short);
+    case ValueDtype::Integer16_U: return typeid(unsigned short);
+    case ValueDtype::Integer32:   return typeid(int);
+    case ValueDtype::Integer32_U: return typeid(unsigned int);
+    case ValueDtype::Integer64:   return typeid(long long);
+    case ValueDtype::Integer64_U: return typeid(unsigned long long);
+    case ValueDtype::Float32:     return typeid(float);
+    case ValueDtype::Float64:     return typeid(double);
+    case ValueDtype::Float128:    return typeid(long double);
+    case ValueDtype::String:      return typeid(std::string);
+    default:
+      throw std::runtime_error("Value data type is not supported by the node table: "+ValueDtypeNames[dtype]);
+    }
+  }
+  
+  template <typename T, typename S>
+  void NodeTable::append_value(BaseValue* value) {
+    std::vector<S>& pool = std::get<std::vector<S>>(pools);
+    value_offsets.push_back(pool.size());
+    BaseArrayValue<T>* array = dynamic_cast<BaseArrayValue<T>*>(value);
+    if (array) {
+      flags.back() |= FLAG_ARRAY;
+      if constexpr (std::is_same_v<T, bool>) {
+	std::vector<uint8_t> bytes = array->get_value().to_bytes();
+	pool.insert(pool.end(), bytes.begin(), bytes.end());
+      } else {
+	for (const T& item: array->get_value())
+	  pool.push_back(item);
+      }
+    } else {
+      pool.push_back(static_cast<T>(*value));
+    }
+    value_sizes.push_back(pool.size()-value_offsets.back());
+  }
+
+  NodeTable::NodeTable(const NodeList& nodes) {
+    name_offsets.push_back(0);
+    shape_offsets.push_back(0);
+    unit_names.push_back("");
+    std::unordered_map<std::string, uint32_t> unit_index;
+    for (size_t i=0; i<nodes.size(); i++) {
+      ValueNode::PointerType vnode = to_value_node(nodes.at(i));
+      if (!vnode or vnode->value==nullptr)
+	throw std::runtime_error("Node table can store only value nodes with values: "+nodes.at(i)->name);
+      name_data += vnode->name;
+      name_offsets.push_back(name_data.size());
+      dtypes.push_back(vnode->value->dtype);
+      flags.push_back(vnode->constant ? FLAG_CONSTANT : 0);
+      // units are stored only once
+      if (vnode->units_raw.empty()) {
+	unit_ids.push_back(0);
+      } else {
+	auto [it, inserted] = unit_index.try_emplace(vnode->units_raw, unit_names.size());
+	if (inserted)
+	  unit_names.push_back(vnode->units_raw);
+	unit_ids.push_back(it->second);
+      }
+      for (int dim: vnode->value->get_shape())
+	shape_data.push_back(dim);
+      shape_offsets.push_back(shape_data.size());
+      BaseValue* value = vnode->value.get();
+      switch (value->dtype) {
+      case ValueDtype::Boolean:     append_value<bool, uint8_t>(value);  break;
+      case ValueDtype::Integer16:   append_value<short>(value);              break;
+      case ValueDtype::Integer16_U: append_value<unsigned short>(value);     break;
+      case ValueDtype::Integer32:   append_value<int>(value);                break;
+      case ValueDtype::Integer32_U: append_value<unsigned int>(value);       break;
+      case ValueDtype::Integer64:   append_value<long long>(value);          break;
+      case ValueDtype::Integer64_U: append_value<unsigned long long>(value); break;
+      case ValueDtype::Float32:     append_value<float>(value);              break;
+      case ValueDtype::Float64:     append_value<double>(value);             break;
+      case ValueDtype::Float128:    append_value<long double>(value);        break;
+      case ValueDtype::String:      append_value<std::string>(value);        break;
+      default:
+	throw std::runtime_error("Value data type is not supported by the node table: "+ValueDtypeNames[value->dtype]);
+      }
+    }
+    // index with at most half of the slots occupied; finalized nodes have unique names
+    size_t num_slots = 2;
+    while (num_slots < 2*size())
+      num_slots *= 2;
+    slots.assign(num_slots, 0);
+    for (size_t i=0; i<size(); i++) {
+      size_t slot = std::hash<std::string_view>{}(name(i)) & (num_slots-1);
+      while (slots[slot]!=0)
+	slot = (slot+1) & (num_slots-1);
+      slots[slot] = i+1;
+    }
+  }
+
+  size_t NodeTable::find(std::string_view nm) const {
+    if (slots.empty())
+      return npos;
+    size_t slot = std::hash<std::string_view>{}(nm) & (slots.size()-1);
+    while (slots[slot]!=0) {
+      if (name(slots[slot]-1)==nm)
+	return slots[slot]-1;
+      slot = (slot+1) & (slots.size()-1);
+    }
+    return npos;
+  }
+  
+  std::string_view NodeTable::name(const size_t position) const {
+    return std::string_view(name_data).substr(name_offsets.at(position), name_offsets.at(position+1)-name_offsets.at(position));
+  }
+
+  std::span<const int> NodeTable::shape(const size_t position) const {
+    return std::span<const int>(shape_data.data()+shape_offsets.at(position), shape_offsets.at(position+1)-shape_offsets.at(position));
+  }
+  
+}
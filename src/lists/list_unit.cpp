@@ -1,11 +1,18 @@
 #include <stdexcept>
+#include <mutex>
 
 #include "lists.h"
 #include "../environment.h"
 
 namespace dip {
 
-  UnitList::UnitList() {
+  struct UnitList::ConversionCache {
+    std::mutex mutex;
+    std::unordered_map<std::string, UnitConversion> entries;
+    UnitCacheStats stats = {0, 0};
+  };
+  
+  UnitList::UnitList(): conversions(std::make_shared<ConversionCache>()) {
   }
 
   void UnitList::append(const std::string& name, const std::string& definition) {
@@ -36,4 +43,35 @@ namespace dip {
       return it->second;
   }
   
+  UnitConversion UnitList::conversion(const std::string& from_units, const std::string& to_units) const {
+    // unit strings cannot contain a null character, so it separates the two units in the key
+    std::string key = from_units+std::string(1,'\0')+to_units;
+    {
+      std::lock_guard<std::mutex> lock(conversions->mutex);
+      auto it = conversions->entries.find(key);
+      if (it!=conversions->entries.end()) {
+	conversions->stats.hits++;
+	return it->second;
+      }
+      conversions->stats.misses++;
+    }
+    UnitConversion conversion = unit_conversion(from_units, to_units);
+    std::lock_guard<std::mutex> lock(conversions->mutex);
+    conversions->entries.insert({key, conversion});
+    return conversion;
+  }
+
+  void UnitList::convert_units(BaseValue& value, const std::string& from_units, const std::string& to_units) const {
+    UnitConversion conv = conversion(from_units, to_units);
+    if (conv.linear)
+      value.convert_units(conv);
+    else
+      value.convert_units(from_units, std::make_unique<puq::Quantity>(to_units));
+  }
+
+  UnitCacheStats UnitList::cache_stats() const {
+    std::lock_guard<std::mutex> lock(conversions->mutex);
+    return conversions->stats;
+  }
+  
 }
@@ -2,23 +2,78 @@
 #define DIP_LISTS_H
 
 #include <map>
+#include <unordered_map>
+#include <deque>
+#include <shared_mutex>
+#include <atomic>
+#include <string_view>
 #include <memory>
 #include <string>
 #include <vector>
+#include <tuple>
+#include <span>
+#include <typeinfo>
+#include <cstdint>
 
 #include "../settings.h"
 #include "../nodes/nodes.h"
 
 namespace dip {
 
+  // Path table
+
+  // Node names are interned as paths, each given by its parent path and a leaf symbol.
+  // A table is shared by the lists of an environment and its copies, and it is released with them.
+  class PathTable {
+  private:
+    // Paths are stored in a deque so that returned references stay valid when new paths are added.
+    // Full names of the paths are kept as well, because nodes still carry their names as strings.
+    struct PathEntry {
+      PathId parent;
+      SymbolId symbol;
+      std::string name;
+    };
+    static std::atomic<uint64_t> num_tables;
+    uint64_t table_id;                                       // unique ID of the table, never zero
+    mutable std::shared_mutex mutex;
+    std::deque<PathEntry> paths;
+    std::deque<std::string> symbols;
+    std::unordered_map<std::string_view, SymbolId> symbol_ids;
+    std::unordered_map<uint64_t, PathId> children;          // paths indexed by their parent and symbol IDs
+    std::unordered_map<std::string_view, PathId> path_ids;
+    PathId intern_child(const PathId parent, const SymbolId symbol);
+  public:
+    PathTable();
+    uint64_t id() const {return table_id;};
+    PathId intern(const PathId parent, std::string_view name);
+    PathId intern(const PathId parent, const std::vector<SymbolId>& path_symbols);
+    PathId find(std::string_view name) const;
+    std::vector<SymbolId> path_symbols(const PathId id) const;
+    const std::string& path_name(const PathId id) const;
+    const std::string& symbol_name(const SymbolId id) const;
+  };
+  
   // Node List
   
+  // Nodes are indexed by their interned names; names of the nodes must not change while they are in the list
   class NodeList {
   private:
+    struct IndexEntry {
+      long long position;  // absolute position of the last node with a given name
+      size_t count;        // number of nodes with a given name
+    };
     BaseNode::NodeListType nodes;
+    std::shared_ptr<PathTable> paths;            // created with the first node, unless it is shared
+    std::unordered_map<PathId, IndexEntry> index;
+    std::map<std::string_view, PathId> sorted; // interned names in the index sorted for prefix searches
+    long long offset = 0;  // absolute position of the first node
+    PathId node_path(const BaseNode::PointerType& node) const;
+    IndexEntry& insert(const BaseNode::PointerType& node, const long long position);
+    void unindex(const BaseNode::PointerType& node, const long long position);
   public:
     NodeList() {};
-    NodeList(const BaseNode::NodeListType& nl): nodes(nl) {};
+    NodeList(std::shared_ptr<PathTable> pt): paths(std::move(pt)) {};
+    NodeList(const BaseNode::NodeListType& nl);
     size_t size() const;
     void push_front(BaseNode::PointerType node);
     void push_back(BaseNode::PointerType node);
@@ -26,30 +81,99 @@ namespace dip {
     BaseNode::PointerType pop_back();
     BaseNode::PointerType at(const size_t index);
     BaseNode::PointerType at(const size_t index) const;
+    BaseNode::PointerType find(const std::string& name) const;
+    BaseNode::NodeListType find_prefix(const std::string& prefix) const;
   };
 
+  // Node table
+
+  // Read-only table of finalized value nodes stored as a structure of arrays.
+  // Values are copied into contiguous pools of their C++ types; booleans are stored as bytes.
+  class NodeTable {
+  public:
+    static constexpr size_t npos = -1;
+  private:
+    enum Flags: uint8_t {
+      FLAG_CONSTANT = 1,                    // node is a constant
+      FLAG_ARRAY    = 2                     // value is an array
+    };
+    std::string name_data;                  // concatenated names of the nodes
+    std::vector<uint32_t> name_offsets;     // name boundaries in name_data
+    std::vector<uint32_t> slots;            // open addressing index of names; empty slots are zero, otherwise position+1
+    std::vector<ValueDtype> dtypes;
+    std::vector<uint8_t> flags;
+    std::vector<uint32_t> unit_ids;         // position in unit_names; zero for nondimensional values
+    std::vector<std::string> unit_names;
+    std::vector<uint32_t> value_offsets;    // position of the first value item in the pool of its type
+    std::vector<uint32_t> value_sizes;      // number of value items
+    std::vector<uint32_t> shape_offsets;    // shape boundaries in shape_data
+    Array::ShapeType shape_data;
+    std::tuple<std::vector<uint8_t>,
+	       std::vector<short>, std::vector<unsigned short>,
+	       std::vector<int>, std::vector<unsigned int>,
+	       std::vector<long long>, std::vector<unsigned long long>,
+	       std::vector<float>, std::vector<double>, std::vector<long double>,
+	       std::vector<std::string>> pools;
+    template <typename T, typename S=T>
+    void append_value(BaseValue* value);
+    static const std::type_info& value_type(const ValueDtype dtype);
+  public:
+    NodeTable() {};
+    NodeTable(const NodeList& nodes);
+    size_t size() const {return dtypes.size();};
+    size_t find(std::string_view name) const;
+    std::string_view name(const size_t position) const;
+    ValueDtype dtype(const size_t position) const {return dtypes.at(position);};
+    bool is_constant(const size_t position) const {return flags.at(position) & FLAG_CONSTANT;};
+    bool is_array(const size_t position) const {return flags.at(position) & FLAG_ARRAY;};
+    uint32_t unit_id(const size_t position) const {return unit_ids.at(position);};
+    const std::string& units(const size_t position) const {return unit_names.at(unit_ids.at(position));};
+    std::span<const int> shape(const size_t position) const;
+    size_t value_size(const size_t position) const {return value_sizes.at(position);};
+    // Values of a node; the requested type has to match the node data type
+    template <typename T>
+    std::span<const T> values(const size_t position) const {
+      if (value_type(dtypes.at(position))!=typeid(T))
+	throw std::runtime_error("Requested value type does not match the node data type: "+std::string(name(position)));
+      return std::span<const T>(std::get<std::vector<T>>(pools).data()+value_offsets[position], value_size(position));
+    };
+  };
+  
   // Source list
   
   class SourceList; // EnvSource needs a forward declaration
+
+  // File that parsed nodes depend on, identified by its content
+  struct SourceDependency {
+    std::string path;   // canonical file path
+    size_t hash;        // hash of the file content
+    long long mtime;    // modification time of the file; zero if it has to be verified by the hash
+    uintmax_t size;     // size of the file
+  };
   
   struct EnvSource {
     std::string name;   // source key
     std::string path;   // source path
-    std::string code;   // source code
+    SourceCode code;    // source code
     Source parent;      // parent source
     NodeList nodes;     // parsed nodes
+    std::vector<SourceDependency> dependencies; // the source file and all files of its nested sources
     //std::shared_ptr<SourceList> sources;
   };
   
+  // Sources are shared between copies of the list and each source is copied only when it is accessed for modification
   class SourceList {
   private:
-    std::map<std::string,EnvSource> sources;
+    std::map<std::string,std::shared_ptr<EnvSource>> sources;
   public:
     SourceList();
-    void append(const std::string& name, const std::string& path, const std::string& code, const Source& parent);
-    void append(const std::string& name, const EnvSource& src);
+    void append(const std::string& name, const std::string& path, const SourceCode& code, const Source& parent);
+    void append(const std::string& name, EnvSource src);
+    void append(const std::string& name, std::shared_ptr<EnvSource> src);
     EnvSource& at(const std::string& name);
     const EnvSource& at(const std::string& name) const;
+    std::vector<SourceDependency> dependencies() const;
+    void release();
   };
 
   // Unit list
@@ -59,28 +183,42 @@ namespace dip {
     std::string definition;   // unit definition
   };
   
+  struct UnitCacheStats {
+    size_t hits;    // number of conversions taken from the cache
+    size_t misses;  // number of conversions evaluated by puq
+  };
+  
+  // Conversion coefficients are cached by pairs of unit strings and shared between copies of the list
   class UnitList {
   private:
+    struct ConversionCache;
     std::map<std::string,EnvUnit> units;
+    std::shared_ptr<ConversionCache> conversions;
   public:
     UnitList();
     void append(const std::string& name, const std::string& definition);
     void append(const std::string& name, const EnvUnit& src);
     EnvUnit& at(const std::string& name);
     const EnvUnit& at(const std::string& name) const;
+    UnitConversion conversion(const std::string& from_units, const std::string& to_units) const;
+    void convert_units(BaseValue& value, const std::string& from_units, const std::string& to_units) const;
+    UnitCacheStats cache_stats() const;
   };  
   
   // Hierarchy list
   
   struct Parent {
     size_t indent;
-    std::string name;
+    PathId path;
   };
   
   class HierarchyList {
   private:
     std::vector<Parent> parents;
+    std::shared_ptr<PathTable> paths;
   public:
+    HierarchyList(): paths(std::make_shared<PathTable>()) {};
+    HierarchyList(std::shared_ptr<PathTable> pt): paths(std::move(pt)) {};
     void record(BaseNode::PointerType node, const std::vector<NodeDtype>& excluded);
   };
 
@@ -100,28 +238,34 @@ namespace dip {
   struct Branch {
     std::vector<size_t> cases;        // list of case IDs
     std::vector<CaseType> types;      // list of case types
-    std::map<std::string, size_t> nodes; // number of node definitions
+    std::map<PathId, size_t> nodes;   // number of node definitions
+    size_t num_true = 0;              // number of cases with a true value
   };
   
   class BranchingList {
   private:
     std::vector<size_t> state;         // list of openned branches
-    std::map<size_t, Branch> branches; // all branches
-    std::map<size_t, Case> cases;      // all cases
+    std::vector<Branch> branches;      // all branches indexed by their IDs
+    std::vector<Case> cases;           // all cases indexed by their IDs
     int num_cases;                          
     int num_branches;
+    bool inactive;                     // cached value of false_case()
+    std::shared_ptr<PathTable> paths;  // table of the cleaned paths
     size_t get_branch_id();
     size_t get_case_id(size_t branch_id=0);
     int open_branch(const size_t case_id);
     int switch_case(const size_t case_id, const CaseType case_type);
     void close_branch();
+    void update_state();
   public:
-    BranchingList(): num_cases(0), num_branches(0) {};
+    BranchingList(): num_cases(0), num_branches(0), inactive(false), paths(std::make_shared<PathTable>()) {};
+    BranchingList(std::shared_ptr<PathTable> pt): num_cases(0), num_branches(0), inactive(false), paths(std::move(pt)) {};
     int register_case();
     bool false_case();
     void solve_case(BaseNode::PointerType node);
     void prepare_node(BaseNode::PointerType node);
     std::string clean_name(const std::string& node);
+    PathId clean_path(const PathId path);
   };
 
   class FunctionList {
@@ -129,9 +273,11 @@ namespace dip {
     typedef BaseValue::PointerType (*ValueFunctionType)(const Environment& env);
     typedef BaseNode::NodeListType (*TableFunctionType)(const Environment& env);
   private:
-    std::map<std::string, ValueFunctionType> value_functions;
-    std::map<std::string, TableFunctionType> table_functions;
+    // function maps are shared between copies of the list and copied only when a new function is added
+    std::shared_ptr<std::map<std::string, ValueFunctionType>> value_functions;
+    std::shared_ptr<std::map<std::string, TableFunctionType>> table_functions;
   public:
+    FunctionList();
     void append_value(const std::string& name, ValueFunctionType func);
     void append_table(const std::string& name, TableFunctionType func);
     ValueFunctionType get_value(const std::string& name) const;
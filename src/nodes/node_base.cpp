@@ -4,25 +4,34 @@
 
 namespace dip {
   
+  // Parsed parts are moved from the parser, because every parser creates at most one node
   BaseNode::BaseNode(Parser& parser, const NodeDtype dt): dtype(dt) {
-    line = parser.line;
+    line = std::move(parser.line);
     indent = parser.indent;
-    name = parser.name;
-    dtype_raw = parser.dtype_raw;
-    dimension = parser.dimension;
-    value_raw = parser.value_raw;
-    value_shape = parser.value_shape;
+    name = std::move(parser.name);
+    dtype_raw = std::move(parser.dtype_raw);
+    dimension = std::move(parser.dimension);
+    value_raw = std::move(parser.value_raw);
+    value_literal = parser.value_literal;
+    value_shape = std::move(parser.value_shape);
     value_origin = parser.value_origin;
-    value_slice = parser.value_slice;
-    units_raw = parser.units_raw;
+    value_slice = std::move(parser.value_slice);
+    units_raw = std::move(parser.units_raw);
   }
   
   BaseNode::NodeListType BaseNode::parse(Environment& env) {
     return {};
   }
 
+  // Release the raw value strings and the source code line once the node value was cast
+  void BaseNode::release_raw() {
+    Array::StringType().swap(value_raw);
+    value_literal = {};
+    line.release();
+  }
+
   bool BaseNode::set_property(PropertyType property, Array::StringType& values, std::string& units) {
-    throw std::runtime_error("Properties are not implemented for this node: "+line.code);
+    throw std::runtime_error("Properties are not implemented for this node: "+std::string(line.code));
     return false;
   }
   
@@ -20,7 +20,7 @@ namespace dip {
 
   BaseNode::NodeListType BooleanNode::parse(Environment& env) {
     if (!units_raw.empty())
-      throw std::runtime_error("Boolean data type does not support units: "+line.code);
+      throw std::runtime_error("Boolean data type does not support units: "+std::string(line.code));
     switch (value_origin) {
     case ValueOrigin::Function:
       set_value(env.request_value(value_raw.at(0), RequestType::Function));
@@ -29,10 +29,10 @@ namespace dip {
       set_value(env.request_value(value_raw.at(0), RequestType::Reference));
       break;
     case ValueOrigin::ReferenceRaw: {
-      std::string source_code = env.request_code(value_raw.at(0));
+      SourceCode source_code = env.request_code(value_raw.at(0));
       Array::StringType source_value_raw;
       Array::ShapeType source_value_shape;
-      parse_value(source_code, source_value_raw, source_value_shape);
+      parse_value(source_code->view(), source_value_raw, source_value_shape);
       set_value(cast_value(source_value_raw, source_value_shape));
       break;
     }
@@ -58,8 +58,9 @@ namespace dip {
       throw std::runtime_error("Value cannot be casted as boolean from the given string: "+value_input);
   }
   
-  BaseValue::PointerType BooleanNode::cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape) const {
-    std::vector<bool> bool_values;
+  BaseValue::PointerType BooleanNode::cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape, std::string_view value_literal) const {
+    BitArray bool_values;
+    bool_values.reserve(value_inputs.size());
     for (auto value: value_inputs) {
       if (value==KEYWORD_TRUE)
 	bool_values.push_back(true);
@@ -68,7 +69,7 @@ namespace dip {
       else
 	throw std::runtime_error("Value cannot be casted as boolean from the given string: "+value);
     }    
-    return std::make_unique<ArrayValue<bool>>(bool_values, shape, value_dtype);    
+    return std::make_unique<ArrayValue<bool>>(std::move(bool_values), shape, value_dtype);    
   }
 
   BaseNode::PointerType BooleanNode::clone(const std::string& nm) const {
@@ -80,7 +81,7 @@ namespace dip {
   
   void BooleanNode::validate_options() const {
     if (format.size()>0)
-      throw std::runtime_error("Options property is not implemented for boolean nodes: "+line.code);
+      throw std::runtime_error("Options property is not implemented for boolean nodes: "+std::string(line.code));
   }
   
 }
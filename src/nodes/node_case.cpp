@@ -1,5 +1,3 @@
-#include <regex>
-
 #include "nodes.h"
 #include "../environment.h"
 
@@ -15,27 +13,28 @@ namespace dip {
   }  
 
   BaseNode::NodeListType CaseNode::parse(Environment& env) {
-    std::ostringstream oss;
-    oss << "^(" << PATTERN_PATH << "*[" << SIGN_CONDITION << "])";
-    oss << "(" << KEYWORD_CASE << "|" << KEYWORD_ELSE << "|" << KEYWORD_END << ")";
-    std::regex pattern(oss.str());
-    std::smatch matchResult;
-    if (std::regex_search(name, matchResult, pattern)) {
-      case_id = env.branching.register_case();
-      if (matchResult[2].str() == KEYWORD_CASE) {
+    // names of case nodes have a form PATH*[@](case|else|end)
+    size_t pos = 0;
+    while (pos<name.size() and (std::isalnum(static_cast<unsigned char>(name[pos])) or
+				 name[pos]=='.' or name[pos]=='_' or name[pos]=='-'))
+      pos++;
+    if (pos<name.size() and name[pos]==SIGN_CONDITION) {
+      std::string_view keyword = std::string_view(name).substr(pos+1);
+      if (keyword.starts_with(KEYWORD_CASE)) {
 	case_type = CaseType::Case;
-      } else if (matchResult[2].str() == KEYWORD_ELSE) {
+      } else if (keyword.starts_with(KEYWORD_ELSE)) {
 	case_type = CaseType::Else;
-      } else if (matchResult[2].str() == KEYWORD_END) {
+      } else if (keyword.starts_with(KEYWORD_END)) {
 	case_type = CaseType::End;
       } else {
-	throw std::runtime_error("Unsupported case type: "+line.code);
+	return {};
       }
-      name = matchResult[1].str() + "C" + std::to_string(case_id);
+      case_id = env.branching.register_case();
+      name = name.substr(0, pos+1) + "C" + std::to_string(case_id);
       if (case_type==CaseType::Case) {
 	// TODO: use logical solver to solve cases
 	if (value_raw.empty())
-	  throw std::runtime_error("Case node requires an input value: "+line.code);
+	  throw std::runtime_error("Case node requires an input value: "+std::string(line.code));
 	value = (value_raw.at(0)==KEYWORD_TRUE) ? true : false;
       } else if (case_type==CaseType::Else) {
 	value = true;
@@ -37,11 +37,11 @@ namespace dip {
       set_value(env.request_value(value_raw.at(0), RequestType::Reference, units_raw));
       break;
     case ValueOrigin::ReferenceRaw: {
-      std::string source_code = env.request_code(value_raw.at(0));
+      SourceCode source_code = env.request_code(value_raw.at(0));
       Array::StringType source_value_raw;
       Array::ShapeType source_value_shape;
-      parse_value(source_code, source_value_raw, source_value_shape);
-      set_value(cast_value(source_value_raw, source_value_shape));
+      std::string_view source_literal = parse_value(source_code->view(), source_value_raw, source_value_shape, !dimension.empty());
+      set_value(cast_value(source_value_raw, source_value_shape, source_literal));
       break;
     }
     case ValueOrigin::Expression: {
@@ -59,36 +59,27 @@ namespace dip {
     // TODO: variable precision x should be implemented
     switch (value_dtype) {
     case ValueDtype::Float32:
-      return std::make_unique<ScalarValue<float>>(std::stof(value_input), ValueDtype::Float32);
+      return std::make_unique<ScalarValue<float>>(parse_number<float>(value_input), ValueDtype::Float32);
     case ValueDtype::Float64:
-      return std::make_unique<ScalarValue<double>>(std::stod(value_input), ValueDtype::Float64);
+      return std::make_unique<ScalarValue<double>>(parse_number<double>(value_input), ValueDtype::Float64);
     case ValueDtype::Float128:
-      return std::make_unique<ScalarValue<long double>>(std::stold(value_input), ValueDtype::Float128);
+      return std::make_unique<ScalarValue<long double>>(parse_number<long double>(value_input), ValueDtype::Float128);
     default:
       throw std::runtime_error("Value cannot be casted as "+dtype_raw[2]+" bit floating-point type from the given string: "+value_input);
     }
   }
   
-  BaseValue::PointerType FloatNode::cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape) const {
+  BaseValue::PointerType FloatNode::cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape, std::string_view value_literal) const {
     // TODO: variable precision x should be implemented
     switch (value_dtype) {
     case ValueDtype::Float32: {
-      std::vector<float> arr;
-      arr.reserve(value_inputs.size());
-      for (auto s: value_inputs) arr.push_back(std::stof(s));
-      return std::make_unique<ArrayValue<float>>(arr, shape, ValueDtype::Float32);
+      return std::make_unique<ArrayValue<float>>(parse_array_numbers<float>(value_inputs, value_literal), shape, ValueDtype::Float32);
     }
     case ValueDtype::Float64: {
-      std::vector<double> arr;
-      arr.reserve(value_inputs.size());
-      for (auto s: value_inputs) arr.push_back(std::stod(s));
-      return std::make_unique<ArrayValue<double>>(arr, shape, ValueDtype::Float64);
+      return std::make_unique<ArrayValue<double>>(parse_array_numbers<double>(value_inputs, value_literal), shape, ValueDtype::Float64);
     }
     case ValueDtype::Float128: {
-      std::vector<long double> arr;
-      arr.reserve(value_inputs.size());
-      for (auto s: value_inputs) arr.push_back(std::stold(s));
-      return std::make_unique<ArrayValue<long double>>(arr, shape, ValueDtype::Float128);
+      return std::make_unique<ArrayValue<long double>>(parse_array_numbers<long double>(value_inputs, value_literal), shape, ValueDtype::Float128);
     }
     default:
       std::ostringstream oss;
@@ -27,7 +27,7 @@ namespace dip {
       nodes = env.request_nodes(value_raw.at(0), RequestType::Reference);
       break;
     default:
-      throw std::runtime_error("Import nodes could not be parsed: "+line.code);      
+      throw std::runtime_error("Import nodes could not be parsed: "+std::string(line.code));      
     }
     // update node settings
     for (auto node: nodes) {
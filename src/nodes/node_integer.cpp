@@ -38,11 +38,11 @@ namespace dip {
       break;
     }
     case ValueOrigin::ReferenceRaw: {
-      std::string source_code = env.request_code(value_raw.at(0));
+      SourceCode source_code = env.request_code(value_raw.at(0));
       Array::StringType source_value_raw;
       Array::ShapeType source_value_shape;
-      parse_value(source_code, source_value_raw, source_value_shape);
-      set_value(cast_value(source_value_raw, source_value_shape));
+      std::string_view source_literal = parse_value(source_code->view(), source_value_raw, source_value_shape, !dimension.empty());
+      set_value(cast_value(source_value_raw, source_value_shape, source_literal));
       break;
     }
     case ValueOrigin::Expression: {
@@ -60,22 +60,22 @@ namespace dip {
     // TODO: variable precision x should be implemented
     switch (value_dtype) {
     case ValueDtype::Integer16_U:
-      return std::make_unique<ScalarValue<unsigned short>>((unsigned short)std::stoi(value_input), ValueDtype::Integer16_U);
+      return std::make_unique<ScalarValue<unsigned short>>(parse_number<unsigned short>(value_input), ValueDtype::Integer16_U);
       break;
     case ValueDtype::Integer16:
-      return std::make_unique<ScalarValue<short>>((short)std::stoi(value_input), ValueDtype::Integer16);
+      return std::make_unique<ScalarValue<short>>(parse_number<short>(value_input), ValueDtype::Integer16);
       break;
     case ValueDtype::Integer32_U:
-      return std::make_unique<ScalarValue<unsigned int>>(std::stoi(value_input), ValueDtype::Integer32_U);
+      return std::make_unique<ScalarValue<unsigned int>>(parse_number<unsigned int>(value_input), ValueDtype::Integer32_U);
       break;
     case ValueDtype::Integer32:
-      return std::make_unique<ScalarValue<int>>(std::stoi(value_input), ValueDtype::Integer32);
+      return std::make_unique<ScalarValue<int>>(parse_number<int>(value_input), ValueDtype::Integer32);
       break;
     case ValueDtype::Integer64_U:
-      return std::make_unique<ScalarValue<unsigned long long>>(std::stoull(value_input), ValueDtype::Integer64_U);
+      return std::make_unique<ScalarValue<unsigned long long>>(parse_number<unsigned long long>(value_input), ValueDtype::Integer64_U);
       break;
     case ValueDtype::Integer64:
-      return std::make_unique<ScalarValue<long long>>(std::stoll(value_input), ValueDtype::Integer64);
+      return std::make_unique<ScalarValue<long long>>(parse_number<long long>(value_input), ValueDtype::Integer64);
       break;
     default:
       if (dtype_raw[0]=="u")
@@ -85,44 +85,26 @@ namespace dip {
     }
   }
 
-  BaseValue::PointerType IntegerNode::cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape) const {
+  BaseValue::PointerType IntegerNode::cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape, std::string_view value_literal) const {
     // TODO: variable precision x should be implemented
     switch (value_dtype) {
     case ValueDtype::Integer16_U: {
-      std::vector<unsigned short> arr;
-      arr.reserve(value_inputs.size());
-      for (auto s: value_inputs) arr.push_back((unsigned short)std::stoul(s));
-      return std::make_unique<ArrayValue<unsigned short>>(arr, shape, ValueDtype::Integer16_U);
+      return std::make_unique<ArrayValue<unsigned short>>(parse_array_numbers<unsigned short>(value_inputs, value_literal), shape, ValueDtype::Integer16_U);
     }
     case ValueDtype::Integer16: {
-      std::vector<short> arr;
-      arr.reserve(value_inputs.size());
-      for (auto s: value_inputs) arr.push_back((short)std::stoi(s));
-      return std::make_unique<ArrayValue<short>>(arr, shape, ValueDtype::Integer16);
+      return std::make_unique<ArrayValue<short>>(parse_array_numbers<short>(value_inputs, value_literal), shape, ValueDtype::Integer16);
     }
     case ValueDtype::Integer32_U: {
-      std::vector<unsigned int> arr;
-      arr.reserve(value_inputs.size());
-      for (auto s: value_inputs) arr.push_back(std::stoul(s));
-      return std::make_unique<ArrayValue<unsigned int>>(arr, shape, ValueDtype::Integer32_U);
+      return std::make_unique<ArrayValue<unsigned int>>(parse_array_numbers<unsigned int>(value_inputs, value_literal), shape, ValueDtype::Integer32_U);
     }
     case ValueDtype::Integer32: {
-      std::vector<int> arr;
-      arr.reserve(value_inputs.size());
-      for (auto s: value_inputs) arr.push_back(std::stoi(s));
-      return std::make_unique<ArrayValue<int>>(arr, shape, ValueDtype::Integer32);
+      return std::make_unique<ArrayValue<int>>(parse_array_numbers<int>(value_inputs, value_literal), shape, ValueDtype::Integer32);
     }
     case ValueDtype::Integer64_U: {
-      std::vector<unsigned long long> arr;
-      arr.reserve(value_inputs.size());
-      for (auto s: value_inputs) arr.push_back(std::stoull(s));
-      return std::make_unique<ArrayValue<unsigned long long>>(arr, shape, ValueDtype::Integer64_U);
+      return std::make_unique<ArrayValue<unsigned long long>>(parse_array_numbers<unsigned long long>(value_inputs, value_literal), shape, ValueDtype::Integer64_U);
     }
     case ValueDtype::Integer64: {
-      std::vector<long long> arr;
-      arr.reserve(value_inputs.size());
-      for (auto s: value_inputs) arr.push_back(std::stoll(s));
-      return std::make_unique<ArrayValue<long long>>(arr, shape, ValueDtype::Integer64);
+      return std::make_unique<ArrayValue<long long>>(parse_array_numbers<long long>(value_inputs, value_literal), shape, ValueDtype::Integer64);
     }
     default:
       std::ostringstream oss;
@@ -15,7 +15,7 @@ namespace dip {
       std::string option_units = options[i].units_raw;
       if (!option_units.empty()) {
 	if (units==nullptr)
-	  throw std::runtime_error("Trying to convert '"+option_units+"' into a nondimensional quantity: "+line.code);
+	  throw std::runtime_error("Trying to convert '"+option_units+"' into a nondimensional quantity: "+std::string(line.code));
 	else
 	  options[i].value->convert_units(option_units, units);
       }
@@ -23,8 +23,12 @@ namespace dip {
       // TODO: implement import of a source
       // TODO: implement injection of a source file
       // TODO: implement injection a text file
-    EnvSource senv = parse_source(value_raw.at(0), value_raw.at(1), line.source);
-    env.sources.append(value_raw.at(0), senv);
+    if (prefetched.valid()) {
+      // the parsed source is adopted; it is copied only if it is modified later
+      env.sources.append(value_raw.at(0), prefetched.get());
+      prefetched = {};
+    } else
+      env.sources.append(value_raw.at(0), parse_source(value_raw.at(0), value_raw.at(1), line.source));
     return {};
   }  
  
@@ -20,7 +20,7 @@ namespace dip {
   
   BaseNode::NodeListType StringNode::parse(Environment& env) {
     if (!units_raw.empty())
-      throw std::runtime_error("String data type does not support units: "+line.code);
+      throw std::runtime_error("String data type does not support units: "+std::string(line.code));
     switch (value_origin) {
     case ValueOrigin::Function:
       set_value(env.request_value(value_raw.at(0), RequestType::Function));
@@ -29,10 +29,10 @@ namespace dip {
       set_value(env.request_value(value_raw.at(0), RequestType::Reference));
       break;
     case ValueOrigin::ReferenceRaw: {
-      std::string source_code = env.request_code(value_raw.at(0));
+      SourceCode source_code = env.request_code(value_raw.at(0));
       Array::StringType source_value_raw;
       Array::ShapeType source_value_shape;
-      parse_value(source_code, source_value_raw, source_value_shape);
+      parse_value(source_code->view(), source_value_raw, source_value_shape);
       set_value(cast_value(source_value_raw, source_value_shape));
       break;
     }
@@ -51,7 +51,7 @@ namespace dip {
     return std::make_unique<ScalarValue<std::string>>(value_input, value_dtype);
   }
 
-  BaseValue::PointerType StringNode::cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape) const {      
+  BaseValue::PointerType StringNode::cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape, std::string_view value_literal) const {      
     return std::make_unique<ArrayValue<std::string>>(value_inputs, shape, value_dtype);
   }
   
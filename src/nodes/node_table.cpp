@@ -18,14 +18,14 @@ namespace dip {
     return nullptr;
   }
 
-  inline BaseNode::NodeListType parse_nodes(const std::string& value_raw, const std::string& source_name, const char delimiter) {
+  inline BaseNode::NodeListType parse_nodes(const SourceCode& source_code, const std::string& source_name, const char delimiter) {
     std::queue<Line> lines;
-    parse_lines(lines, value_raw, source_name);
+    parse_lines(lines, source_code, source_name);
     return parse_table_nodes(lines, delimiter);
   }
   
   BaseNode::NodeListType TableNode::parse(Environment& env) {
-    std::string source_name = line.source.name+"_"+std::string(TABLE_SOURCE);
+    std::string source_name = line.source.name()+"_"+std::string(TABLE_SOURCE);
     NodeListType nodes;
     switch (value_origin) {
     case ValueOrigin::Function:
@@ -38,10 +38,10 @@ namespace dip {
       nodes = parse_nodes(env.request_code(value_raw.at(0)), source_name, delimiter);
       break;
     case ValueOrigin::String:
-      nodes = parse_nodes(value_raw.at(0), source_name, delimiter);
+      nodes = parse_nodes(std::make_shared<const SourceBuffer>(value_raw.at(0)), source_name, delimiter);
       break;
     default:
-      throw std::runtime_error("Table nodes could not be parsed: "+line.code);
+      throw std::runtime_error("Table nodes could not be parsed: "+std::string(line.code));
     }      
     // update node settings
     for (auto node: nodes) {
@@ -1,4 +1,5 @@
 #include "nodes.h"
+#include "../environment.h"
 
 #include <sstream>
 
@@ -16,14 +17,14 @@ namespace dip {
   };
 
   BaseValue::PointerType ValueNode::cast_value() {
-    return cast_value(value_raw, value_shape);
+    return cast_value(value_raw, value_shape, value_literal);
   }
 
-  BaseValue::PointerType ValueNode::cast_value(Array::StringType& value_input, const Array::ShapeType& shape) {
+  BaseValue::PointerType ValueNode::cast_value(Array::StringType& value_input, const Array::ShapeType& shape, std::string_view value_literal) {
     if (!dimension.empty()) {
-      return cast_array_value(value_input, shape);
+      return cast_array_value(value_input, shape, value_literal);
     } else if (value_input.size()>1) {
-      throw std::runtime_error("Value size is an array but node is defined as scalar: "+line.code);
+      throw std::runtime_error("Value size is an array but node is defined as scalar: "+std::string(line.code));
     } else {
       return cast_scalar_value(value_input.at(0));
     }
@@ -38,7 +39,7 @@ namespace dip {
       if (value->dtype!=value_dtype) {
 	std::string d1 = std::string(ValueDtypeNames[value_dtype]);
 	std::string d2 = std::string(ValueDtypeNames[value->dtype]);
-	throw std::runtime_error("Assigning '"+d2+"' value to the '"+d1+"' node: "+line.code);
+	throw std::runtime_error("Assigning '"+d2+"' value to the '"+d1+"' node: "+std::string(line.code));
       }
     }
     if (value!=nullptr) {
@@ -46,7 +47,7 @@ namespace dip {
 	value = value->slice(value_slice);
       if (dimension.empty()) {
 	if (value->get_size()>1)
-	  throw std::runtime_error("Assigning array value to the scalar node: "+line.code);
+	  throw std::runtime_error("Assigning array value to the scalar node: "+std::string(line.code));
       } else {
 	validate_dimensions(); // check if value shape corresponds with dimension ranges
       }
@@ -57,14 +58,15 @@ namespace dip {
     if (node->dtype!=NodeDtype::Modification and node->dtype!=dtype)
       throw std::runtime_error("Node '"+name+"' with type '"+dtype_raw.at(1)+"' cannot modify node '"+node->name+"' with type '"+node->dtype_raw.at(1)+"'");
     BaseValue::PointerType value = cast_value(node->value_raw, node->value_shape);
-    QuantityNode* qnode = dynamic_cast<QuantityNode*>(this);
+    QuantityNode* qnode = quantity_node();
     if (qnode and !node->units_raw.empty()) {
       if (qnode->units==nullptr)
-	throw std::runtime_error("Trying to convert '"+node->units_raw+"' into a nondimensional quantity: "+line.code);
+	throw std::runtime_error("Trying to convert '"+node->units_raw+"' into a nondimensional quantity: "+std::string(line.code));
       else
-	value->convert_units(node->units_raw, qnode->units);
+	env.units.convert_units(*value, node->units_raw, qnode->units_raw);
     }
     value_raw = node->value_raw;
+    value_literal = {};
     set_value(std::move(value));
   }
 
@@ -73,7 +75,7 @@ namespace dip {
     case PropertyType::Options:
       for (auto value_option: values) {
 	if (dtype==NodeDtype::Boolean)
-	      throw std::runtime_error("Option property is not implemented for boolean nodes: "+line.code);
+	      throw std::runtime_error("Option property is not implemented for boolean nodes: "+std::string(line.code));
 	// TODO: account for multidimensional arrays as individual options
 	BaseValue::PointerType ovalue = cast_scalar_value(value_option);
 	options.push_back({std::move(ovalue), value_option, units});
@@ -102,12 +104,12 @@ namespace dip {
   
   void ValueNode::validate_constant() const {
     if (constant)
-      throw std::runtime_error("Node '"+name+"' is constant and cannot be modified: "+line.code);
+      throw std::runtime_error("Node '"+name+"' is constant and cannot be modified: "+std::string(line.code));
   }
   
   void ValueNode::validate_definition() const {
     if (value==nullptr) 
-      throw std::runtime_error("Declared node has undefined value: "+line.code);
+      throw std::runtime_error("Declared node has undefined value: "+std::string(line.code));
   }
 
   void ValueNode::validate_condition() const {
@@ -140,7 +142,7 @@ namespace dip {
 
   void ValueNode::validate_format() const {
     if (format.size()>0)
-      throw std::runtime_error("Format property can be used only with string nodes: "+line.code);
+      throw std::runtime_error("Format property can be used only with string nodes: "+std::string(line.code));
   }
 
   void ValueNode::validate_dimensions() const {
@@ -6,6 +6,8 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <string_view>
+#include <future>
 
 #include "../settings.h"
 #include "../values/values.h"
@@ -22,6 +24,7 @@ namespace dip {
     Group, Case, Import,                                   // node structure
     Boolean, Integer, Float, String, Table, Modification,  // data handling
     Property,                                              // properties
+    Lazy,                                                  // unclassified lines
   };
   
   enum class PropertyType {
@@ -35,28 +38,39 @@ namespace dip {
     Line line;                             // source code line information; in Python this were 'code' & 'source' variables
     size_t indent;                         // indent of a node
     std::string name;                      // node name
+    PathId path;                           // interned node name; zero if it was not interned yet
+    uint64_t path_table;                   // ID of the path table that interned the name
     std::array<std::string,3> dtype_raw;   // data type properties (unsigned/type/precision)
     Array::StringType value_raw;           // raw value string(s)
+    std::string_view value_literal;        // numeric array literal in the line buffer; empty if values are given only by value_raw
     Array::ShapeType value_shape;          // shape of an array value
     ValueOrigin value_origin;              // origin of the value; in Python there were separate variables: value_ref, value_expr, value_func
     Array::RangeType value_slice;          // slice of an injected node value
     std::string units_raw;                 // raw units string
     Array::RangeType dimension;            // list of array dimensions
-    Node(): indent(0), value_origin(ValueOrigin::String) {};
-    Node(const Line& l): line(l), indent(0), value_origin(ValueOrigin::String) {};
-    Node(const std::string& nm): name(nm), indent(0), value_origin(ValueOrigin::String) {};
+    Node(): indent(0), path(0), path_table(0), value_origin(ValueOrigin::String) {};
+    Node(const Line& l): line(l), indent(0), path(0), path_table(0), value_origin(ValueOrigin::String) {};
+    Node(const std::string& nm): name(nm), indent(0), path(0), path_table(0), value_origin(ValueOrigin::String) {};
     virtual ~Node() = default;
     std::string to_string();
   };
   
+  enum class ParserMode {
+    Regex,                                 // parts are matched by regular expressions
+    Lexer                                  // parts are matched by a single-pass character scanning
+  };
+  
   class Parser: public Node {
   private:
-    void strip(const std::string& text); 
+    void strip(const size_t length); 
     static const std::array<std::string, 3> ESCAPE_SYMBOLS;
   public:
-    std::string code;                      // in Python this was 'ccode', the original 'code' is now in the 'line' struct
+    static ParserMode default_mode;        // mode of newly created parsers
+    ParserMode mode;
+    std::string_view code;                 // in Python this was 'ccode'; unparsed rest of the original code in the 'line' struct
     std::string comment;
-    Parser(const Line& l): Node(l), code(l.code) {};
+    Parser(const Line& l, const ParserMode m=default_mode): Node(l), mode(m), code(line.code) {};
+    Parser(const Parser& other) = delete;  // 'code' points into the own 'line
     static void encode_escape_symbols(std::string& str);
     static void decode_escape_symbols(std::string& str);
     bool do_continue();
@@ -84,6 +98,9 @@ namespace dip {
     bool part_delimiter(const char symbol, const bool required=true);
   };
 
+  class ValueNode;     // value and quantity nodes are accessed from the base node without dynamic casts
+  class QuantityNode;
+
   class BaseNode: virtual public Node {
   public:
     NodeDtype dtype;                       // data type of a node; in Python this was 'keyword' variable in Node class
@@ -97,6 +114,9 @@ namespace dip {
     virtual ~BaseNode() = default;
     virtual NodeListType parse(Environment& env);
     virtual bool set_property(PropertyType property, Array::StringType& values, std::string& units);
+    void release_raw();
+    virtual ValueNode* value_node() {return nullptr;};
+    virtual QuantityNode* quantity_node() {return nullptr;};
   };
 
   class EmptyNode: public BaseNode {
@@ -121,6 +141,8 @@ namespace dip {
   
   class SourceNode: public BaseNode {
   public:
+    typedef std::shared_ptr<SourceNode> PointerType;
+    std::shared_future<std::shared_ptr<EnvSource>> prefetched; // source parsed in advance, if available
     static BaseNode::PointerType is_node(Parser& parser);
     SourceNode(Parser& parser): BaseNode(parser, NodeDtype::Source) {};
     BaseNode::NodeListType parse(Environment& env) override;
@@ -136,6 +158,19 @@ namespace dip {
     BaseNode::NodeListType parse(Environment& env) override;
   };
   
+  // Code lines of a case branch that are converted into nodes only if the case is active;
+  // otherwise only their indent and name are used for the node hierarchy
+  class LazyNode: public BaseNode {
+  public:
+    typedef std::shared_ptr<LazyNode> PointerType;
+    std::vector<Line> lines;   // node line followed by its property lines
+    LazyNode(const Line& l, const size_t ind, std::string_view nm): BaseNode(NodeDtype::Lazy), lines({l}) {
+      line = l;
+      indent = ind;
+      name = nm;
+    };
+  };
+
   class GroupNode: public BaseNode {
   public:
     static BaseNode::PointerType is_node(Parser& parser);
@@ -163,7 +198,7 @@ namespace dip {
   
   class ValueNode: virtual public BaseNode {
     virtual BaseValue::PointerType cast_scalar_value(const std::string& value_input) const = 0;
-    virtual BaseValue::PointerType cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape) const = 0;
+    virtual BaseValue::PointerType cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape, std::string_view value_literal) const = 0;
   protected:
     struct OptionStruct {
       BaseValue::PointerType value;
@@ -185,11 +220,12 @@ namespace dip {
     ValueNode(const std::string& nm, BaseValue::PointerType val, const ValueDtype vdt);
     virtual ~ValueNode() = default;
     BaseValue::PointerType cast_value();
-    BaseValue::PointerType cast_value(Array::StringType& value_input, const Array::ShapeType& shape);
+    BaseValue::PointerType cast_value(Array::StringType& value_input, const Array::ShapeType& shape, std::string_view value_literal={});
     void set_value(BaseValue::PointerType value_input=nullptr);
     void modify_value(BaseNode::PointerType node, Environment& env);
     virtual BaseNode::PointerType clone(const std::string& nm) const = 0;
     virtual bool set_property(PropertyType property, Array::StringType& values, std::string& units) override;
+    ValueNode* value_node() override {return this;};
     void validate_constant() const;
     void validate_definition() const;
     void validate_condition() const;
@@ -201,7 +237,7 @@ namespace dip {
   
   class BooleanNode: public ValueNode {
     BaseValue::PointerType cast_scalar_value(const std::string& value_input) const override;
-    BaseValue::PointerType cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape) const override;
+    BaseValue::PointerType cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape, std::string_view value_literal) const override;
   public:
     static BaseNode::PointerType is_node(Parser& parser);
     BooleanNode(const std::string& nm, BaseValue::PointerType val): BaseNode(NodeDtype::Boolean), ValueNode(nm, std::move(val), ValueDtype::Boolean) {};
@@ -213,7 +249,7 @@ namespace dip {
   
   class StringNode: public ValueNode {
     BaseValue::PointerType cast_scalar_value(const std::string& value_input) const override;
-    BaseValue::PointerType cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape) const override;
+    BaseValue::PointerType cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape, std::string_view value_literal) const override;
   public:
     static BaseNode::PointerType is_node(Parser& parser);
     StringNode(const std::string& nm, BaseValue::PointerType val): BaseNode(NodeDtype::String), ValueNode(nm, std::move(val), ValueDtype::String) {};
@@ -233,16 +269,17 @@ namespace dip {
     typedef std::shared_ptr<QuantityNode> PointerType;
     Quantity::PointerType units;
     void set_units(Quantity::PointerType units_input=nullptr);
+    QuantityNode* quantity_node() override {return this;};
     virtual ~QuantityNode() = default;
   };
   
   class IntegerNode: public QuantityNode {
     BaseValue::PointerType cast_scalar_value(const std::string& value_input) const override;
-    BaseValue::PointerType cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape) const override;
+    BaseValue::PointerType cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape, std::string_view value_literal) const override;
   public:
     static constexpr size_t max_int_size = sizeof(long long) * CHAR_BIT;
     static BaseNode::PointerType is_node(Parser& parser);
-    IntegerNode(const std::string& nm, BaseValue::PointerType val, const ValueDtype vdt): BaseNode(NodeDtype::Boolean), ValueNode(nm, std::move(val), vdt) {};
+    IntegerNode(const std::string& nm, BaseValue::PointerType val, const ValueDtype vdt): BaseNode(NodeDtype::Integer), ValueNode(nm, std::move(val), vdt) {};
     IntegerNode(Parser& parser);
     BaseNode::NodeListType parse(Environment& env) override;
     BaseNode::PointerType clone(const std::string& nm) const override;
@@ -250,7 +287,7 @@ namespace dip {
   
   class FloatNode: public QuantityNode {
     BaseValue::PointerType cast_scalar_value(const std::string& value_input) const override;
-    BaseValue::PointerType cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape) const override;
+    BaseValue::PointerType cast_array_value(const Array::StringType& value_inputs, const Array::ShapeType& shape, std::string_view value_literal) const override;
   public:
     static constexpr size_t max_float_size = sizeof(long double) * CHAR_BIT;
     static BaseNode::PointerType is_node(Parser& parser);
@@ -264,7 +301,7 @@ namespace dip {
    *  Property nodes
    */
 
-  class PropertyNode: public virtual BaseNode {
+  class PropertyNode: public BaseNode {
   public:
     typedef std::shared_ptr<PropertyNode> PointerType;
     PropertyType ptype; 
@@ -272,6 +309,28 @@ namespace dip {
     PropertyNode(Parser& parser, PropertyType pt): BaseNode(parser, NodeDtype::Property), ptype(pt) {};
   };
   
+  // helper functions that cast nodes to value and quantity nodes; the data type of a node is checked first
+  // and the virtual base is resolved by a single virtual call instead of a dynamic cast
+  inline bool is_value_node(const NodeDtype dtype) {
+    return dtype==NodeDtype::Boolean or dtype==NodeDtype::Integer or dtype==NodeDtype::Float or dtype==NodeDtype::String;
+  }
+  
+  inline bool is_quantity_node(const NodeDtype dtype) {
+    return dtype==NodeDtype::Integer or dtype==NodeDtype::Float;
+  }
+  
+  inline ValueNode::PointerType to_value_node(const BaseNode::PointerType& node) {
+    if (node==nullptr or !is_value_node(node->dtype))
+      return nullptr;
+    return ValueNode::PointerType(node, node->value_node());
+  }
+
+  inline QuantityNode::PointerType to_quantity_node(const BaseNode::PointerType& node) {
+    if (node==nullptr or !is_quantity_node(node->dtype))
+      return nullptr;
+    return QuantityNode::PointerType(node, node->quantity_node());
+  }
+  
   // helper function that create a scalar value node pointer from a C++ data type
   template <typename T>
   BaseNode::PointerType create_scalar_node(const std::string& name, const T value) {
@@ -2,6 +2,10 @@
 #include <sstream>
 #include <iostream>
 #include <stdexcept>
+#include <map>
+#include <mutex>
+#include <cstdlib>
+#include <string_view>
 
 #include "nodes.h"
 #include "../parsers.h"
@@ -11,8 +15,355 @@ namespace dip {
 
   const std::array<std::string, 3> Parser::ESCAPE_SYMBOLS = {"\\\"", "\\'", "\\n"};
   
-  void Parser::strip(const std::string& text) {
-    code = code.substr(text.length(), code.length());
+  /*
+   * Compiled regular expressions
+   */
+
+  constexpr auto PATTERN_CASE     = ce_concat<50>("^(", PATTERN_PATH, "*[", SIGN_CONDITION, "]", KEYWORD_CASE, ")[ ]*");
+  constexpr auto PATTERN_ELSE_END = ce_concat<50>("^", PATTERN_PATH, "*(",
+						  "[", SIGN_CONDITION, "]", KEYWORD_ELSE, "|"
+						  "[", SIGN_CONDITION, "]", KEYWORD_END , ")");
+  constexpr auto PATTERN_UNIT     = ce_concat<50>("^(", PATTERN_PATH, "*[", SIGN_VARIABLE, "]", KEYWORD_UNIT, ")[ ]*");
+  constexpr auto PATTERN_SOURCE   = ce_concat<50>("^(", PATTERN_PATH, "*[", SIGN_VARIABLE, "]", KEYWORD_SOURCE, ")[ ]*");
+  constexpr auto PATTERN_PROPERTY = ce_concat<50>("^[", SIGN_VALIDATION, "](", PATTERN_KEY, "+)[ ]*");
+  constexpr auto PATTERN_NAME     = ce_concat<50>("^", PATTERN_PATH, "+");
+  constexpr auto PATTERN_TYPE     = ce_concat<70>("^[ ]+(u|)(", KEYWORD_BOOLEAN, "|", KEYWORD_INTEGER, "|", KEYWORD_FLOAT, "|",
+						  KEYWORD_STRING, "|table)(16|32|64|128|x|)");
+  constexpr auto PATTERN_EQUAL    = ce_concat<50>("^[ ]*[", SIGN_EQUAL, "][ ]*");
+  constexpr auto PATTERN_REFERENCE = ce_concat<50>("^[ ]*[{](", PATTERN_KEY, "*([?]", PATTERN_PATH, "*|))[}]");
+  constexpr auto PATTERN_FUNCTION = ce_concat<50>("^[ ]*[(](", PATTERN_KEY, "+)[)]");
+  constexpr auto PATTERN_KEYWORD  = ce_concat<50>("^", PATTERN_KEY, "+");
+
+  // All patterns are compiled only once, when the first parser is used.
+  // Initialization of a function-local static is thread-safe and std::regex
+  // objects can be shared between threads as long as they are only read.
+  struct ParserPatterns {
+    static constexpr auto flags = std::regex::ECMAScript | std::regex::optimize;
+    const std::regex kwd_case       = std::regex(PATTERN_CASE.data(), flags);
+    const std::regex kwd_else_end   = std::regex(PATTERN_ELSE_END.data(), flags);
+    const std::regex kwd_unit       = std::regex(PATTERN_UNIT.data(), flags);
+    const std::regex kwd_source     = std::regex(PATTERN_SOURCE.data(), flags);
+    const std::regex kwd_property   = std::regex(PATTERN_PROPERTY.data(), flags);
+    const std::regex part_indent    = std::regex("^[ ]+", flags);
+    const std::regex part_name      = std::regex(PATTERN_NAME.data(), flags);
+    const std::regex part_type      = std::regex(PATTERN_TYPE.data(), flags);
+    const std::regex part_dimension = std::regex("^\\[([0-9:,]*)\\]", flags);
+    const std::regex part_equal     = std::regex(PATTERN_EQUAL.data(), flags);
+    const std::regex part_reference = std::regex(PATTERN_REFERENCE.data(), flags);
+    const std::regex part_function  = std::regex(PATTERN_FUNCTION.data(), flags);
+    const std::regex part_expression = std::regex("^[(](\"\"\"([^\"]*)\"\"\"|\"([^\"]*)\"|\'([^\']*)\')[)]", flags);
+    const std::regex part_string    = std::regex("^(\"\"\"([^\"]*)\"\"\"|\"([^\"]*)\"|\'([^\']*)\'|((?!#)[^ ]+))", flags);
+    const std::regex part_keyword   = std::regex(PATTERN_KEYWORD.data(), flags);
+    const std::regex part_slice     = std::regex("^\\[([0-9:,]*)\\]", flags);
+    const std::regex part_units     = std::regex("^[ ]+([^#= ]+)", flags);
+    const std::regex part_units_sign = std::regex("^[ ]+[/*+-]+", flags);
+    const std::regex part_comment   = std::regex("^[ ]*#[ ]*(.*)$", flags);
+  };
+
+  inline const ParserPatterns& patterns() {
+    static const ParserPatterns compiled;
+    return compiled;
+  }
+
+  // Delimiter patterns depend on a runtime symbol, so they are compiled on demand and cached
+  inline const std::regex& delimiter_pattern(const char symbol) {
+    static std::mutex mutex;
+    static std::map<char, std::regex> compiled;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = compiled.find(symbol);
+    if (it==compiled.end()) {
+      std::ostringstream oss;
+      oss << "^[ ]*[" << symbol << "][ ]*";
+      it = compiled.emplace(symbol, std::regex(oss.str(), ParserPatterns::flags)).first;
+    }
+    return it->second;
+  }
+
+  /*
+   * Parser mode
+   */
+
+  // regular expression parsing can be enforced by setting DIP_PARSER_MODE=regex
+  inline ParserMode initial_parser_mode() {
+    const char* mode = std::getenv("DIP_PARSER_MODE");
+    if (mode!=nullptr and std::string(mode)=="regex")
+      return ParserMode::Regex;
+    return ParserMode::Lexer;
+  }
+
+  ParserMode Parser::default_mode = initial_parser_mode();
+
+  /*
+   * Matched parts of a code line
+   */
+
+  // Both parser modes return the same match structure with the whole match
+  // in the group 0 and all captured groups in the same order as in the
+  // regular expressions above. Unmatched groups are empty.
+  struct PartMatch {
+    bool found;
+    std::array<std::string_view, 6> groups;
+    PartMatch(): found(false) {};
+    PartMatch(std::string_view code, const size_t length): found(true) {
+      groups[0] = code.substr(0, length);
+    };
+    void set(const size_t group, std::string_view code, const size_t begin, const size_t end) {
+      groups[group] = code.substr(begin, end-begin);
+    };
+    std::string str(const size_t group) const {
+      return std::string(groups[group]);
+    };
+    size_t length() const {
+      return groups[0].size();
+    };
+    explicit operator bool() const {
+      return found;
+    };
+  };
+
+  inline PartMatch search(std::string_view code, const std::regex& pattern) {
+    std::match_results<std::string_view::const_iterator> result;
+    if (!std::regex_search(code.begin(), code.end(), result, pattern))
+      return PartMatch();
+    PartMatch match(code, result[0].length());
+    for (size_t i=1; i<result.size() and i<match.groups.size(); i++)
+      if (result[i].matched)
+	match.set(i, code, result[i].first-code.begin(), result[i].second-code.begin());
+    return match;
+  }
+
+  /*
+   * Single-pass character scanning
+   */
+
+  inline bool is_space(const char c) {
+    return c==' ';
+  }
+
+  inline bool is_key(const char c) {
+    return ('a'<=c and c<='z') or ('A'<=c and c<='Z') or ('0'<=c and c<='9') or c=='_' or c=='-';
+  }
+
+  inline bool is_path(const char c) {
+    return is_key(c) or c==SIGN_SEPARATOR;
+  }
+
+  inline bool is_slice(const char c) {
+    return ('0'<=c and c<='9') or c==SEPARATOR_SLICE or c==SEPARATOR_DIMENSION;
+  }
+
+  // return position of the first character after 'pos' that does not satisfy the condition
+  template <typename F>
+  inline size_t scan(std::string_view code, size_t pos, F condition) {
+    while (pos<code.size() and condition(code[pos]))
+      pos++;
+    return pos;
+  }
+
+  inline bool has_char(std::string_view code, const size_t pos, const char symbol) {
+    return pos<code.size() and code[pos]==symbol;
+  }
+
+  inline bool has_keyword(std::string_view code, const size_t pos, const char sign, std::string_view keyword) {
+    return has_char(code, pos, sign) and code.substr(pos+1).starts_with(keyword);
+  }
+
+  // ^(PATH*[sign]keyword)[ ]*
+  inline PartMatch lex_directive(std::string_view code, const char sign, std::string_view keyword) {
+    size_t pos = scan(code, 0, is_path);
+    if (!has_keyword(code, pos, sign, keyword))
+      return PartMatch();
+    size_t end = pos+1+keyword.size();
+    PartMatch match(code, scan(code, end, is_space));
+    match.set(1, code, 0, end);
+    return match;
+  }
+
+  // ^PATH*([@]else|[@]end)
+  inline PartMatch lex_else_end(std::string_view code) {
+    size_t pos = scan(code, 0, is_path);
+    for (std::string_view keyword: {KEYWORD_ELSE, KEYWORD_END}) {
+      if (has_keyword(code, pos, SIGN_CONDITION, keyword)) {
+	PartMatch match(code, pos+1+keyword.size());
+	match.set(1, code, pos, pos+1+keyword.size());
+	return match;
+      }
+    }
+    return PartMatch();
+  }
+
+  // ^[!](KEY+)[ ]*
+  inline PartMatch lex_property(std::string_view code) {
+    if (!has_char(code, 0, SIGN_VALIDATION))
+      return PartMatch();
+    size_t end = scan(code, 1, is_key);
+    if (end==1)
+      return PartMatch();
+    PartMatch match(code, scan(code, end, is_space));
+    match.set(1, code, 1, end);
+    return match;
+  }
+
+  // ^[ ]+(u|)(bool|int|float|str|table)(16|32|64|128|x|)
+  inline PartMatch lex_type(std::string_view code) {
+    constexpr std::array<std::string_view,5> types = {KEYWORD_BOOLEAN, KEYWORD_INTEGER, KEYWORD_FLOAT, KEYWORD_STRING, "table"};
+    constexpr std::array<std::string_view,5> precisions = {"16", "32", "64", "128", "x"};
+    size_t pos = scan(code, 0, is_space);
+    if (pos==0)
+      return PartMatch();
+    size_t tpos = has_char(code, pos, 'u') ? pos+1 : pos;
+    for (std::string_view type: types) {
+      if (!code.substr(tpos).starts_with(type))
+	continue;
+      size_t ppos = tpos+type.size();
+      size_t end = ppos;
+      for (std::string_view precision: precisions) {
+	if (code.substr(ppos).starts_with(precision)) {
+	  end += precision.size();
+	  break;
+	}
+      }
+      PartMatch match(code, end);
+      match.set(1, code, pos, tpos);
+      match.set(2, code, tpos, ppos);
+      match.set(3, code, ppos, end);
+      return match;
+    }
+    return PartMatch();
+  }
+
+  // ^\[([0-9:,]*)\]
+  inline PartMatch lex_slice(std::string_view code) {
+    if (!has_char(code, 0, SIGN_ARRAY_OPEN))
+      return PartMatch();
+    size_t end = scan(code, 1, is_slice);
+    if (!has_char(code, end, SIGN_ARRAY_CLOSE))
+      return PartMatch();
+    PartMatch match(code, end+1);
+    match.set(1, code, 1, end);
+    return match;
+  }
+
+  // ^[ ]*[symbol][ ]*
+  inline PartMatch lex_symbol(std::string_view code, const char symbol) {
+    size_t pos = scan(code, 0, is_space);
+    if (symbol==' ')
+      return (pos>0) ? PartMatch(code, pos) : PartMatch();
+    if (!has_char(code, pos, symbol))
+      return PartMatch();
+    return PartMatch(code, scan(code, pos+1, is_space));
+  }
+
+  // ^[ ]*[{](KEY*([?]PATH*|))[}]
+  inline PartMatch lex_reference(std::string_view code) {
+    size_t pos = scan(code, 0, is_space);
+    if (!has_char(code, pos, '{'))
+      return PartMatch();
+    size_t qpos = scan(code, pos+1, is_key);
+    size_t end = has_char(code, qpos, SIGN_QUERY) ? scan(code, qpos+1, is_path) : qpos;
+    if (!has_char(code, end, '}'))
+      return PartMatch();
+    PartMatch match(code, end+1);
+    match.set(1, code, pos+1, end);
+    match.set(2, code, qpos, end);
+    return match;
+  }
+
+  // ^[ ]*[(](KEY+)[)]
+  inline PartMatch lex_function(std::string_view code) {
+    size_t pos = scan(code, 0, is_space);
+    if (!has_char(code, pos, '('))
+      return PartMatch();
+    size_t end = scan(code, pos+1, is_key);
+    if (end==pos+1 or !has_char(code, end, ')'))
+      return PartMatch();
+    PartMatch match(code, end+1);
+    match.set(1, code, pos+1, end);
+    return match;
+  }
+
+  // ("""([^"]*)"""|"([^"]*)"|'([^']*)') starting at 'pos', captured into groups 2, 3 and 4
+  inline PartMatch lex_quotes(std::string_view code, const size_t pos) {
+    if (code.substr(pos).starts_with(SIGN_BLOCK)) {
+      size_t begin = pos+SIGN_BLOCK.size();
+      size_t end = code.find('"', begin);
+      if (end!=std::string_view::npos and code.substr(end).starts_with(SIGN_BLOCK)) {
+	PartMatch match(code, end+SIGN_BLOCK.size());
+	match.set(2, code, begin, end);
+	return match;
+      }
+    }
+    for (size_t group: {3, 4}) {
+      char quote = (group==3) ? '"' : '\'';
+      if (!has_char(code, pos, quote))
+	continue;
+      size_t end = code.find(quote, pos+1);
+      if (end==std::string_view::npos)
+	return PartMatch();
+      PartMatch match(code, end+1);
+      match.set(group, code, pos+1, end);
+      return match;
+    }
+    return PartMatch();
+  }
+
+  // ^[(]("""([^"]*)"""|"([^"]*)"|'([^']*)')[)]
+  inline PartMatch lex_expression(std::string_view code) {
+    if (!has_char(code, 0, '('))
+      return PartMatch();
+    PartMatch match = lex_quotes(code, 1);
+    if (!match or !has_char(code, match.length(), ')'))
+      return PartMatch();
+    match.groups[0] = code.substr(0, match.length()+1);
+    return match;
+  }
+
+  // ^("""([^"]*)"""|"([^"]*)"|'([^']*)'|((?!#)[^ ]+))
+  inline PartMatch lex_string(std::string_view code) {
+    PartMatch match = lex_quotes(code, 0);
+    if (match or code.empty() or code[0]=='#' or code[0]==' ')
+      return match;
+    size_t end = scan(code, 0, [](const char c){return c!=' ';});
+    match = PartMatch(code, end);
+    match.set(5, code, 0, end);
+    return match;
+  }
+
+  // ^[ ]+([^#= ]+) unless the rest of the code is ^[ ]+[/*+-]+$
+  inline PartMatch lex_units(std::string_view code) {
+    size_t pos = scan(code, 0, is_space);
+    if (pos==0)
+      return PartMatch();
+    size_t end = scan(code, pos, [](const char c){return c!='#' and c!=SIGN_EQUAL and c!=' ';});
+    if (end==pos)
+      return PartMatch();
+    size_t sign = scan(code, pos, [](const char c){return c=='/' or c=='*' or c=='+' or c=='-';});
+    if (sign>pos and sign==code.size())
+      return PartMatch();
+    PartMatch match(code, end);
+    match.set(1, code, pos, end);
+    return match;
+  }
+
+  // ^[ ]*#[ ]*(.*)$
+  inline PartMatch lex_comment(std::string_view code) {
+    size_t pos = scan(code, 0, is_space);
+    if (!has_char(code, pos, '#'))
+      return PartMatch();
+    pos = scan(code, pos+1, is_space);
+    if (code.find_first_of("\n\r", pos)!=std::string_view::npos)
+      return PartMatch();
+    PartMatch match(code, code.size());
+    match.set(1, code, pos, code.size());
+    return match;
+  }
+
+  /*
+   * Parser methods
+   */
+
+  void Parser::strip(const size_t length) {
+    code.remove_prefix(length);
   }
 
   bool Parser::do_continue() {
@@ -45,26 +396,23 @@ namespace dip {
     }
   }
   
+
   /*
    * Directive keywords
    */
 
   bool Parser::kwd_case() {
-    constexpr auto pstr = ce_concat<50>("^(", PATTERN_PATH, "*[", SIGN_CONDITION, "]", KEYWORD_CASE, ")[ ]*");
-    std::regex pattern(pstr.data());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      name = matchResult[1].str();
-      strip(matchResult[0].str());
+    bool lexer = (mode==ParserMode::Lexer);
+    PartMatch match = lexer ? lex_directive(code, SIGN_CONDITION, KEYWORD_CASE) : search(code, patterns().kwd_case);
+    if (match) {
+      name = match.str(1);
+      strip(match.length());
       return true;
     } else {
-      constexpr auto pstr = ce_concat<50>("^", PATTERN_PATH, "*(",
-					   "[", SIGN_CONDITION, "]", KEYWORD_ELSE, "|"
-					   "[", SIGN_CONDITION, "]", KEYWORD_END , ")");
-      pattern = pstr.data();
-      if (std::regex_search(code, matchResult, pattern)) {
-	name = matchResult[0].str();
-	strip(matchResult[0].str());
+      match = lexer ? lex_else_end(code) : search(code, patterns().kwd_else_end);
+      if (match) {
+	name = match.str(0);
+	strip(match.length());
 	return true;
       }
     }
@@ -72,35 +420,29 @@ namespace dip {
   }
   
   bool Parser::kwd_unit() {
-    constexpr auto pstr = ce_concat<50>("^(", PATTERN_PATH, "*[", SIGN_VARIABLE, "]", KEYWORD_UNIT, ")[ ]*");
-    std::regex pattern(pstr.data());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      name = matchResult[1].str();
-      strip(matchResult[0].str());
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_directive(code, SIGN_VARIABLE, KEYWORD_UNIT) : search(code, patterns().kwd_unit);
+    if (match) {
+      name = match.str(1);
+      strip(match.length());
       return true;
     }
     return false;
   }
 
   bool Parser::kwd_source() {
-    constexpr auto pstr = ce_concat<50>("^(", PATTERN_PATH, "*[", SIGN_VARIABLE, "]", KEYWORD_SOURCE, ")[ ]*");
-    std::regex pattern(pstr.data());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      name = matchResult[1].str();
-      strip(matchResult[0].str());
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_directive(code, SIGN_VARIABLE, KEYWORD_SOURCE) : search(code, patterns().kwd_source);
+    if (match) {
+      name = match.str(1);
+      strip(match.length());
       return true;
     }
     return false;
   }
 
   bool Parser::kwd_property(PropertyType& ptype) {
-    constexpr auto pstr = ce_concat<50>("^[", SIGN_VALIDATION, "](", PATTERN_KEY, "+)[ ]*");
-    std::regex pattern(pstr.data());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      std::string key = matchResult[1].str();
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_property(code) : search(code, patterns().kwd_property);
+    if (match) {
+      std::string_view key = match.groups[1];
       if (key==KEYWORD_OPTIONS)	          ptype = PropertyType::Options;
       else if (key==KEYWORD_CONSTANT)	  ptype = PropertyType::Constant;
       else if (key==KEYWORD_FORMAT)	  ptype = PropertyType::Format;
@@ -109,7 +451,7 @@ namespace dip {
       else if (key==KEYWORD_CONDITION)	  ptype = PropertyType::Condition;
       else if (key==KEYWORD_DELIMITER)	  ptype = PropertyType::Delimiter;
       dimension.push_back({0,Array::max_range});
-      strip(matchResult[0].str());
+      strip(match.length());
       return true;
     }
     return false;
@@ -124,48 +466,49 @@ namespace dip {
   }
   
   bool Parser::part_indent() {
-    std::regex pattern("^[ ]+");
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      indent = matchResult[0].str().length();
-      strip(matchResult[0].str());
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_symbol(code, ' ') : search(code, patterns().part_indent);
+    if (match) {
+      indent = match.length();
+      strip(match.length());
       return true;
     }
     return false;
   }
   
   bool Parser::part_name(const bool required) {
-    constexpr auto pstr = ce_concat<50>("^", PATTERN_PATH, "+");
-    std::regex pattern(pstr.data());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      name = matchResult[0].str();
-      strip(matchResult[0].str());
+    PartMatch match;
+    if (mode==ParserMode::Lexer) {
+      size_t end = scan(code, 0, is_path);
+      if (end>0) match = PartMatch(code, end);
+    } else {
+      match = search(code, patterns().part_name);
+    }
+    if (match) {
+      name = match.str(0);
+      strip(match.length());
       if (do_continue() and code[0]!=' ')
-	throw std::runtime_error("Name has an invalid format: "+line.code);
+	throw std::runtime_error("Name has an invalid format: "+std::string(line.code));
       return true;
     } else if (required) {
-      throw std::runtime_error("Name has an invalid format: "+line.code);
+      throw std::runtime_error("Name has an invalid format: "+std::string(line.code));
     }
     return false;
   }
   
   bool Parser::part_type(const bool required) {
-    constexpr auto pstr = ce_concat<70>("^[ ]+(u|)(", KEYWORD_BOOLEAN, "|", KEYWORD_INTEGER, "|", KEYWORD_FLOAT, "|", KEYWORD_STRING, "|table)(16|32|64|128|x|)");
-    std::regex pattern(pstr.data());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      dtype_raw = {matchResult[1].str(), matchResult[2].str(), matchResult[3].str()};
-      strip(matchResult[0].str());
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_type(code) : search(code, patterns().part_type);
+    if (match) {
+      dtype_raw = {match.str(1), match.str(2), match.str(3)};
+      strip(match.length());
       return true;
     } else if (required) {
-      throw std::runtime_error("Type not recognized: "+line.code);
+      throw std::runtime_error("Type not recognized: "+std::string(line.code));
     }
     return false;
   }
 
   bool Parser::part_literal() {
-    std::string trimmed = code;
+    std::string trimmed(code);
     trimmed.erase(0, trimmed.find_first_not_of(" \t\n\r"));
     trimmed.erase(trimmed.find_last_not_of(" \t\n\r") + 1);
     // Check Boolean
@@ -231,45 +574,40 @@ namespace dip {
   }
   
   bool Parser::part_dimension() {
-    std::regex pattern("^\\[([0-9:,]*)\\]");
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      std::string slices = matchResult[1].str();
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_slice(code) : search(code, patterns().part_dimension);
+    if (match) {
+      std::string slices = match.str(1);
       parse_slices(slices, dimension);
       if (dimension.empty())
-	throw std::runtime_error("Dimension settings cannot be empty: "+line.code);
-      strip(matchResult[0].str());
+	throw std::runtime_error("Dimension settings cannot be empty: "+std::string(line.code));
+      strip(match.length());
       return true;
     }
     return false;
   }
 
   bool Parser::part_equal(const bool required) {
-    constexpr auto pstr = ce_concat<50>("^[ ]*[", SIGN_EQUAL, "][ ]*");
-    std::regex pattern(pstr.data());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      strip(matchResult[0].str());
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_symbol(code, SIGN_EQUAL) : search(code, patterns().part_equal);
+    if (match) {
+      strip(match.length());
       return true;
     } else if (required) {
-      throw std::runtime_error("Equal sign '"+std::string(1,SIGN_EQUAL)+"' is required: "+line.code);
+      throw std::runtime_error("Equal sign '"+std::string(1,SIGN_EQUAL)+"' is required: "+std::string(line.code));
     }
     return false;
   }
 
   bool Parser::part_reference() {
-    constexpr auto pstr = ce_concat<50>("^[ ]*[{](", PATTERN_KEY, "*([?]", PATTERN_PATH, "*|))[}]");
-    std::regex pattern(pstr.data());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      value_raw.push_back( matchResult[1].str() );
-      if (!matchResult[2].str().empty())
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_reference(code) : search(code, patterns().part_reference);
+    if (match) {
+      value_raw.push_back( match.str(1) );
+      if (!match.groups[2].empty())
 	value_origin = ValueOrigin::Reference;
-      else if (!matchResult[1].str().empty())
+      else if (!match.groups[1].empty())
 	value_origin = ValueOrigin::ReferenceRaw;
       else
-	throw std::runtime_error("Reference cannot be empty: "+line.code);
-      strip(matchResult[0].str());
+	throw std::runtime_error("Reference cannot be empty: "+std::string(line.code));
+      strip(match.length());
       part_slice();
       return true;
     }
@@ -277,32 +615,29 @@ namespace dip {
   }
   
   bool Parser::part_function() {
-    constexpr auto pstr = ce_concat<50>("^[ ]*[(](", PATTERN_KEY, "+)[)]");
-    std::regex pattern(pstr.data());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      value_raw.push_back( matchResult[1].str() );
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_function(code) : search(code, patterns().part_function);
+    if (match) {
+      value_raw.push_back( match.str(1) );
       value_origin = ValueOrigin::Function;
-      strip(matchResult[0].str());
+      strip(match.length());
       return true;
     }
     return false;
   }
     
   bool Parser::part_expression() {
-    std::regex pattern("^[(](\"\"\"([^\"]*)\"\"\"|\"([^\"]*)\"|\'([^\']*)\')[)]");
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      if (matchResult[2].length())
-	value_raw.push_back( matchResult[2].str() );
-      else if (matchResult[3].length())
-	value_raw.push_back( matchResult[3].str() );
-      else if (matchResult[4].length())
-	value_raw.push_back( matchResult[4].str() );
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_expression(code) : search(code, patterns().part_expression);
+    if (match) {
+      if (match.groups[2].length())
+	value_raw.push_back( match.str(2) );
+      else if (match.groups[3].length())
+	value_raw.push_back( match.str(3) );
+      else if (match.groups[4].length())
+	value_raw.push_back( match.str(4) );
       else
-	throw std::runtime_error("Expression cannot be an empty string: "+line.code);
+	throw std::runtime_error("Expression cannot be an empty string: "+std::string(line.code));
       value_origin = ValueOrigin::Expression;      
-      strip(matchResult[0].str());
+      strip(match.length());
       return true;
     }
     return false;
@@ -312,41 +647,46 @@ namespace dip {
     if (code.empty() or code.at(0)!=SIGN_ARRAY_OPEN)
       return false;
     std::string rm = parse_array(code, value_raw, value_shape);
-    strip(rm);
+    // numeric arrays are later converted directly from their literal
+    if ((dtype_raw[1]==KEYWORD_INTEGER or dtype_raw[1]==KEYWORD_FLOAT) and !dimension.empty())
+      value_literal = code.substr(0, rm.length());
+    strip(rm.length());
     return true;
   }
 
   bool Parser::part_string() {
-    std::regex pattern("^(\"\"\"([^\"]*)\"\"\"|\"([^\"]*)\"|\'([^\']*)\'|((?!#)[^ ]+))");
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_string(code) : search(code, patterns().part_string);
+    if (match) {
       for (int i=2; i<6; i++) {
-	std::string vraw = matchResult[i].str();
-	if (vraw!="") {
-	  value_raw.push_back(vraw);
+	if (!match.groups[i].empty()) {
+	  value_raw.push_back(match.str(i));
 	  value_origin = ValueOrigin::String;
 	  break;
 	}
       }
-      strip(matchResult[0].str());
+      strip(match.length());
       return true;
     }
     return false;
   }
   
   bool Parser::part_keyword(const bool required) {
-    constexpr auto pstr = ce_concat<50>("^", PATTERN_KEY, "+");
-    std::regex pattern(pstr.data());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      value_raw.push_back(matchResult[0].str());
+    PartMatch match;
+    if (mode==ParserMode::Lexer) {
+      size_t end = scan(code, 0, is_key);
+      if (end>0) match = PartMatch(code, end);
+    } else {
+      match = search(code, patterns().part_keyword);
+    }
+    if (match) {
+      value_raw.push_back(match.str(0));
       value_origin = ValueOrigin::Keyword;
-      strip(matchResult[0].str());
+      strip(match.length());
       if (do_continue() and code[0]!=' ')
-	throw std::runtime_error("Key has an invalid format: "+line.code);
+	throw std::runtime_error("Key has an invalid format: "+std::string(line.code));
       return true;
     } else if (required) {
-      throw std::runtime_error("Key has an invalid format: "+line.code);
+      throw std::runtime_error("Key has an invalid format: "+std::string(line.code));
     }
     return false;
   }
@@ -366,14 +706,13 @@ namespace dip {
   }
   
   bool Parser::part_slice() {
-    std::regex pattern("^\\[([0-9:,]*)\\]");
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      std::string slices = matchResult[1].str();
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_slice(code) : search(code, patterns().part_slice);
+    if (match) {
+      std::string slices = match.str(1);
       parse_slices(slices, value_slice);
       if (value_slice.empty())
 	return false;
-      strip(matchResult[0].str());
+      strip(match.length());
       return true;
     }
     return false;
@@ -381,38 +720,36 @@ namespace dip {
     
   bool Parser::part_units() {
     // In numerical expressions starting signs +-*/ have to be explicitely excluded
-    std::regex pattern1("^[ ]+([^#= ]+)");
-    std::regex pattern2("^[ ]+[/*+-]+");
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern1) and !std::regex_match(code, pattern2)) {
-      units_raw = matchResult[1].str();
-      strip(matchResult[0].str());
+    PartMatch match;
+    if (mode==ParserMode::Lexer)
+      match = lex_units(code);
+    else if (!std::regex_match(code.begin(), code.end(), patterns().part_units_sign))
+      match = search(code, patterns().part_units);
+    if (match) {
+      units_raw = match.str(1);
+      strip(match.length());
       return true;
     }
     return false;
   }
     
   bool Parser::part_comment() {
-    std::regex pattern("^[ ]*#[ ]*(.*)$");
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      comment = matchResult[1].str();
-      strip(matchResult[0].str());
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_comment(code) : search(code, patterns().part_comment);
+    if (match) {
+      comment = match.str(1);
+      strip(match.length());
       return true;
     }
     return false;
   }
 
   bool Parser::part_delimiter(const char symbol, const bool required) {
-    std::ostringstream oss;
-    oss << "^[ ]*[" << symbol << "][ ]*";
-    std::regex pattern(oss.str());
-    std::smatch matchResult;
-    if (std::regex_search(code, matchResult, pattern)) {
-      strip(matchResult[0].str());
+    PartMatch match = (mode==ParserMode::Lexer) ? lex_symbol(code, symbol) : search(code, delimiter_pattern(symbol));
+    if (match) {
+      strip(match.length());
       return true;
     } else if (required) {
-      throw std::runtime_error("Delimiter '"+std::string(1,symbol)+"' is required: "+line.code);
+      throw std::runtime_error("Delimiter '"+std::string(1,symbol)+"' is required: "+std::string(line.code));
     }
     return false;
   }
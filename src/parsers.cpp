@@ -1,5 +1,11 @@
 #include <iostream>
 #include <fstream>
+#include <utility>
+#include <filesystem>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+#include <chrono>
 
 #include "parsers.h"
 #include "dip.h"
@@ -7,44 +13,226 @@
 
 namespace dip {
 
+  /*
+   * Cache of parsed sources
+   */
+
+  // Parsed DIP sources are shared by all DIP instances in the process. Cached entries are keyed
+  // by the canonical file path, so a library imported under different names is parsed only once;
+  // its nodes refer to the file path and only the returned EnvSource carries the name of the import.
+  // Entries record the status of all files of their nested sources and are valid only while none
+  // of these files changes. At most MAX_CACHED_SOURCES entries are kept; the least recently used
+  // one is evicted first.
+  struct SourceCacheEntry {
+    SourceCode code;
+    NodeList nodes;
+    std::vector<SourceDependency> dependencies;  // the source file is the first one
+  };
+
+  struct SourceCache {
+    typedef std::list<std::pair<std::string, std::shared_ptr<SourceCacheEntry>>> UsageList;
+    std::mutex mutex;
+    UsageList usage;                                                // entries ordered from the most recently used
+    std::unordered_map<std::string, UsageList::iterator> entries;  // positions of the entries in the usage list
+    SourceCacheStats stats = {0, 0};
+  };
+
+  inline SourceCache& source_cache() {
+    static SourceCache cache;
+    return cache;
+  }
+
+  SourceCacheStats source_cache_stats() {
+    SourceCache& cache = source_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.stats;
+  }
+
+  void clear_source_cache() {
+    SourceCache& cache = source_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.entries.clear();
+    cache.usage.clear();
+    cache.stats = {0, 0};
+  }
+
+  inline size_t content_hash(std::string_view content) {
+    return std::hash<std::string_view>{}(content);
+  }
+
+  // Status of a file has to be taken before its content is read, so that a change during the reading
+  // is detected later. Times of recently modified files are not recorded, because a following change
+  // could keep the same time; such files are always verified by their hash.
+  inline SourceDependency file_status(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::file_time_type mtime = std::filesystem::last_write_time(path, ec);
+    if (ec)
+      return {"", 0, 0, 0};
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+      return {"", 0, 0, 0};
+    if (std::filesystem::file_time_type::clock::now()-mtime < std::chrono::seconds(MIN_STABLE_SOURCE_AGE))
+      return {path, 0, 0, size};
+    return {path, 0, mtime.time_since_epoch().count(), size};
+  }
+  
+  // Check that none of the files changed since the dependencies were recorded; content of a file is
+  // hashed only if its time or size differs. Files that could not be inspected have an empty path and are never valid
+  inline bool dependencies_valid(const std::vector<SourceDependency>& dependencies) {
+    for (const SourceDependency& file: dependencies) {
+      if (file.path.empty())
+	return false;
+      SourceDependency status = file_status(file.path);
+      if (status.path.empty() or status.size!=file.size)
+	return false;
+      if (file.mtime!=0 and status.mtime==file.mtime)
+	continue;
+      try {
+	if (content_hash(SourceBuffer::from_file(file.path)->view())!=file.hash)
+	  return false;
+      } catch (const std::runtime_error&) {
+	return false;
+      }
+    }
+    return true;
+  }
+  
   EnvSource parse_source(const std::string& source_name, const std::string& source_file, const Source& parent) {
+    // files that cannot be inspected are parsed without the cache
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::canonical(source_file, ec);
+    bool cacheable = !ec and std::filesystem::is_regular_file(path, ec) and !ec;
     if (source_file.size() >= FILE_SUFFIX_DIP.size() &&
 	source_file.compare(source_file.size() - FILE_SUFFIX_DIP.size(), FILE_SUFFIX_DIP.size(), FILE_SUFFIX_DIP) == 0) {
-      DIP d(parent);
-      d.add_file(source_file, source_name);
+      if (!cacheable) {
+	DIP d(parent);
+	d.add_file(source_file, source_name);
+	Environment senv = d.parse();
+	std::vector<SourceDependency> dependencies = senv.sources.dependencies();
+	dependencies.insert(dependencies.begin(), {"", 0, 0, 0}); // the file is never a valid dependency
+	return EnvSource({source_name, source_file, std::as_const(senv.sources).at(source_name).code, parent,
+			  std::move(senv.nodes), std::move(dependencies)});
+      }
+      SourceCache& cache = source_cache();
+      std::string key = path.string();
+      std::shared_ptr<SourceCacheEntry> entry;
+      {
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	auto it = cache.entries.find(key);
+	if (it!=cache.entries.end()) {
+	  cache.usage.splice(cache.usage.begin(), cache.usage, it->second);
+	  entry = it->second->second;
+	}
+      }
+      if (entry and dependencies_valid(entry->dependencies)) {
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	cache.stats.hits++;
+	return EnvSource({source_name, source_file, entry->code, parent, entry->nodes, entry->dependencies});
+      }
+      {
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	cache.stats.misses++;
+      }
+      // the file is read only once and the parsed buffer is also the one that is hashed
+      SourceDependency file = file_status(key);
+      SourceCode code = SourceBuffer::from_file(source_file);
+      file.hash = content_hash(code->view());
+      // nodes are named after the file, so that they do not depend on the name of the import;
+      // nested sources are looked up in the cache as well
+      DIP d;
+      d.add_file(source_file, code, key);
       Environment senv = d.parse();
-      return EnvSource({source_name, source_file, senv.sources.at(source_name).code, parent, senv.nodes});
+      std::vector<SourceDependency> dependencies = senv.sources.dependencies();
+      dependencies.insert(dependencies.begin(), file);
+      {
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	auto it = cache.entries.find(key);
+	if (it!=cache.entries.end()) {
+	  cache.usage.erase(it->second);
+	  cache.entries.erase(it);
+	}
+	cache.usage.emplace_front(key, std::make_shared<SourceCacheEntry>(SourceCacheEntry({code, senv.nodes, dependencies})));
+	cache.entries.emplace(key, cache.usage.begin());
+	if (cache.entries.size()>MAX_CACHED_SOURCES) {
+	  cache.entries.erase(cache.usage.back().first);
+	  cache.usage.pop_back();
+	}
+      }
+      return EnvSource({source_name, source_file, code, parent, std::move(senv.nodes), std::move(dependencies)});
     } else {
-      std::ifstream file(source_file);
-      if (!file) 
-	throw std::runtime_error("Following file could not be found: "+source_file);
-      std::ostringstream source_code;
-      source_code << file.rdbuf();
-      return EnvSource({source_name, source_file, source_code.str(), parent});
+      SourceDependency file = cacheable ? file_status(path.string()) : SourceDependency({"", 0, 0, 0});
+      SourceCode code = SourceBuffer::from_file(source_file);
+      file.hash = content_hash(code->view());
+      return EnvSource({source_name, source_file, code, parent, NodeList(), {file}});
     }    
   }
 
-  std::queue<Line> parse_lines(std::queue<Line>& lines, const std::string& source_code, const std::string& source_name) {
-    // parse nodes from a text
-    std::string line;
-    std::istringstream ss(source_code);
-    int line_number = 0;
-    while (std::getline(ss, line)) {
+  /*
+   * Concurrent parsing of sources
+   */
+
+  std::shared_future<std::shared_ptr<EnvSource>> SourcePrefetch::add(const std::string& source_name, const std::string& source_file, const Source& parent) {
+    if (!workers.empty())
+      throw std::runtime_error("Sources cannot be added after their parsing has started: "+source_name);
+    tasks.push_back({source_name, source_file, parent, std::promise<std::shared_ptr<EnvSource>>()});
+    return tasks.back().result.get_future().share();
+  }
+
+  void SourcePrefetch::start(const size_t num_threads) {
+    size_t num_workers = std::min(num_threads, tasks.size());
+    for (size_t i=0; i<num_workers; i++)
+      workers.emplace_back(&SourcePrefetch::work, this);
+  }
+
+  void SourcePrefetch::work() {
+    size_t task_id;
+    while (!cancelled and (task_id = next_task++) < tasks.size()) {
+      Task& task = tasks[task_id];
+      try {
+	task.result.set_value(std::make_shared<EnvSource>(parse_source(task.name, task.path, task.parent)));
+      } catch (...) {
+	task.result.set_exception(std::current_exception());
+      }
+    }
+  }
+
+  SourcePrefetch::~SourcePrefetch() {
+    cancelled = true;
+    for (auto& worker: workers)
+      worker.join();
+  }
+  
+  std::queue<Line> parse_lines(std::queue<Line>& lines, const SourceCode& source_code, const std::string& source_name, const int first_line) {
+    // parse nodes from a text; lines only point into the source code buffer
+    std::string_view code = source_code->view();
+    SourceName shared_name = std::make_shared<const std::string>(source_name);
+    int line_number = first_line;
+    size_t begin = 0;
+    while (begin<code.size()) {
+      size_t end = code.find(SEPARATOR_NEWLINE, begin);
+      if (end==std::string_view::npos)
+	end = code.size();
+      std::string_view line = code.substr(begin, end-begin);
       // skip empty lines
       if (!line.empty() and !std::all_of(line.begin(), line.end(), isspace))
-	lines.push({line, {source_name, line_number}});
+	lines.push(Line(line, Source(shared_name, line_number), source_code));
       line_number++;
+      begin = end+1;
     }
     return lines;
   }
+
+  std::queue<Line> parse_lines(std::queue<Line>& lines, const std::string& source_code, const std::string& source_name, const int first_line) {
+    return parse_lines(lines, std::make_shared<const SourceBuffer>(source_code), source_name, first_line);
+  }
   
-  BaseNode::NodeListType parse_code_nodes(std::queue<Line>& lines) {
-    BaseNode::NodeListType nodes;
+  inline std::vector<Line> group_block_strings(std::queue<Line>& lines) {
+    // merge lines of block strings into single lines
+    std::vector<Line> grouped;
+    grouped.reserve(lines.size());
     while (!lines.empty()) {
       Line line = lines.front();
       lines.pop();
-      
-      // group block strings
       size_t pos = 0;
       if ((pos = line.code.find(SIGN_BLOCK)) != std::string::npos) {      // opening block quotes
 	pos += SIGN_BLOCK.length();
@@ -60,49 +248,149 @@ namespace dip {
 	    }
 	  }
 	}
-	line.code = oss.str();
+	line = Line(oss.str(), line.source);
       }
-      
-      // add replacement mark for escape symbols
-      Parser::encode_escape_symbols(line.code);
-      
-      // determine node type
-      Parser parser(line);
-      BaseNode::PointerType node = nullptr;
-      node = EmptyNode::is_node(parser);
-      if (node==nullptr) parser.part_indent();
-      if (node==nullptr) node = ImportNode::is_node(parser);
-      if (node==nullptr) node = UnitNode::is_node(parser);
-      if (node==nullptr) node = SourceNode::is_node(parser);
-      if (node==nullptr) node = CaseNode::is_node(parser);
-      if (node==nullptr) node = PropertyNode::is_node(parser);      
-      if (node==nullptr) parser.part_name();
-      if (node==nullptr) node = GroupNode::is_node(parser);
-      if (node==nullptr) node = ImportNode::is_node(parser);
-      if (node==nullptr) node = ModificationNode::is_node(parser);
-      if (node==nullptr) parser.part_type();
-      if (node==nullptr) node = BooleanNode::is_node(parser);
-      if (node==nullptr) node = IntegerNode::is_node(parser);
-      if (node==nullptr) node = FloatNode::is_node(parser);
-      if (node==nullptr) node = StringNode::is_node(parser);
-      if (node==nullptr) node = TableNode::is_node(parser);
+      grouped.push_back(line);
+    }
+    return grouped;
+  }
 
-      // make sure that everything was parsed
-      if (node==nullptr)
-	throw std::runtime_error("Node could not be determined from : "+line.code);
-      if (parser.do_continue())
-	throw std::runtime_error("Could not parse all text on the line: "+line.code);
+  inline BaseNode::PointerType classify_line(const Line& line) {
+    // add replacement mark for escape symbols; only such lines need their own copy of the code
+    Line parser_line = line;
+    if (line.code.find('\\')!=std::string_view::npos) {
+      std::string code(line.code);
+      Parser::encode_escape_symbols(code);
+      parser_line = Line(code, line.source);
+    }
+      
+    // determine node type
+    Parser parser(parser_line);
+    BaseNode::PointerType node = nullptr;
+    node = EmptyNode::is_node(parser);
+    if (node==nullptr) parser.part_indent();
+    if (node==nullptr) node = ImportNode::is_node(parser);
+    if (node==nullptr) node = UnitNode::is_node(parser);
+    if (node==nullptr) node = SourceNode::is_node(parser);
+    if (node==nullptr) node = CaseNode::is_node(parser);
+    if (node==nullptr) node = PropertyNode::is_node(parser);      
+    if (node==nullptr) parser.part_name();
+    if (node==nullptr) node = GroupNode::is_node(parser);
+    if (node==nullptr) node = ImportNode::is_node(parser);
+    if (node==nullptr) node = ModificationNode::is_node(parser);
+    if (node==nullptr) parser.part_type();
+    if (node==nullptr) node = BooleanNode::is_node(parser);
+    if (node==nullptr) node = IntegerNode::is_node(parser);
+    if (node==nullptr) node = FloatNode::is_node(parser);
+    if (node==nullptr) node = StringNode::is_node(parser);
+    if (node==nullptr) node = TableNode::is_node(parser);
 
-      // convert escape symbols to original characterss
-      for (size_t i=0; i<node->value_raw.size(); i++)
-	Parser::decode_escape_symbols(node->value_raw.at(i));
-      Parser::decode_escape_symbols(node->line.code);
+    // make sure that everything was parsed
+    if (node==nullptr)
+      throw std::runtime_error("Node could not be determined from : "+std::string(line.code));
+    if (parser.do_continue())
+      throw std::runtime_error("Could not parse all text on the line: "+std::string(line.code));
 
-      // put node into the list
-      nodes.push_back(node);
+    // convert escape symbols to original characterss
+    for (size_t i=0; i<node->value_raw.size(); i++)
+      Parser::decode_escape_symbols(node->value_raw.at(i));
+    node->line = line;
+    return node;
+  }
+  
+  inline bool is_name_symbol(const char c) {
+    return ('a'<=c and c<='z') or ('A'<=c and c<='Z') or ('0'<=c and c<='9') or c=='_' or c=='-' or c==SIGN_SEPARATOR;
+  }
+  
+  // Replace lines inside of case branches with lazy nodes; only case lines, and lines that
+  // close the branches by a lower indent, are left for classification
+  inline std::vector<BaseNode::PointerType> defer_case_lines(const std::vector<Line>& grouped, std::vector<bool>& merged) {
+    std::vector<BaseNode::PointerType> nodes(grouped.size());
+    merged.assign(grouped.size(), false);
+    std::vector<size_t> branches;   // indents of the open branches
+    LazyNode::PointerType previous = nullptr;
+    for (size_t i=0; i<grouped.size(); i++) {
+      std::string_view code = grouped[i].code;
+      size_t indent = code.find_first_not_of(' ');
+      if (indent==std::string_view::npos or code[indent]=='#')
+	continue;
+      code.remove_prefix(indent);
+      if (code[0]==SIGN_CONDITION) {
+	while (!branches.empty() and branches.back()>indent)
+	  branches.pop_back();
+	if (code.substr(1).starts_with(KEYWORD_END)) {
+	  if (!branches.empty() and branches.back()==indent)
+	    branches.pop_back();
+	} else if (branches.empty() or branches.back()<indent) {
+	  branches.push_back(indent);
+	}
+	previous = nullptr;
+	continue;
+      }
+      while (!branches.empty() and branches.back()>=indent)
+	branches.pop_back();
+      if (branches.empty()) {
+	previous = nullptr;
+      } else if (code[0]==SIGN_VALIDATION) {
+	// properties are classified together with their node
+	if (previous) {
+	  previous->lines.push_back(grouped[i]);
+	  merged[i] = true;
+	}
+      } else {
+	size_t end = 0;
+	while (end<code.size() and is_name_symbol(code[end]))
+	  end++;
+	previous = std::make_shared<LazyNode>(grouped[i], indent, code.substr(0, end));
+	nodes[i] = previous;
+      }
     }
     return nodes;
   }
+  
+  BaseNode::NodeListType parse_code_nodes(std::queue<Line>& lines, const size_t num_threads, const bool lazy) {
+    // block strings are grouped sequentially, afterwards every line is classified independently
+    std::vector<Line> grouped = group_block_strings(lines);
+    std::vector<bool> merged;
+    std::vector<BaseNode::PointerType> nodes = lazy ? defer_case_lines(grouped, merged) : std::vector<BaseNode::PointerType>(grouped.size());
+    size_t num_chunks = std::min(num_threads, grouped.size()/MIN_PARALLEL_LINES);
+    if (num_chunks<=1) {
+      for (size_t i=0; i<grouped.size(); i++)
+	if (nodes[i]==nullptr and !(lazy and merged[i]))
+	  nodes[i] = classify_line(grouped[i]);
+    } else {
+      // each thread classifies a contiguous chunk of lines; the first error in the code order is reported
+      std::vector<std::exception_ptr> errors(num_chunks);
+      std::vector<std::thread> workers;
+      workers.reserve(num_chunks);
+      for (size_t c=0; c<num_chunks; c++) {
+	size_t begin = grouped.size()*c/num_chunks;
+	size_t end = grouped.size()*(c+1)/num_chunks;
+	workers.emplace_back([&grouped, &nodes, &merged, &errors, lazy, c, begin, end]() {
+	  try {
+	    for (size_t i=begin; i<end; i++)
+	      if (nodes[i]==nullptr and !(lazy and merged[i]))
+		nodes[i] = classify_line(grouped[i]);
+	  } catch (...) {
+	    errors[c] = std::current_exception();
+	  }
+	});
+      }
+      for (auto& worker: workers)
+	worker.join();
+      for (auto& error: errors)
+	if (error)
+	  std::rethrow_exception(error);
+    }
+    if (!lazy)
+      return BaseNode::NodeListType(std::make_move_iterator(nodes.begin()), std::make_move_iterator(nodes.end()));
+    // property lines merged into lazy nodes are left out
+    BaseNode::NodeListType queue;
+    for (size_t i=0; i<nodes.size(); i++)
+      if (!merged[i])
+	queue.push_back(std::move(nodes[i]));
+    return queue;
+  }
 
   BaseNode::NodeListType parse_table_nodes(std::queue<Line>& lines, const char delimiter) { 
     // parse nodes from a table header
@@ -122,7 +410,7 @@ namespace dip {
       parser.part_dimension();
       parser.part_units();
       if (parser.do_continue())
-	throw std::runtime_error("Incorrect header format: "+line.code);
+	throw std::runtime_error("Incorrect header format: "+std::string(line.code));
       // initialize actual node
       BaseNode::PointerType node(nullptr);
       if (node==nullptr) node = BooleanNode::is_node(parser);
@@ -131,9 +419,9 @@ namespace dip {
       if (node==nullptr) node = StringNode::is_node(parser);
       // make sure that everything was parsed
       if (node==nullptr)
-	throw std::runtime_error("Node could not be determined from : "+line.code);
+	throw std::runtime_error("Node could not be determined from : "+std::string(line.code));
       if (parser.do_continue())
-	throw std::runtime_error("Could not parse all text on the line: "+line.code);
+	throw std::runtime_error("Could not parse all text on the line: "+std::string(line.code));
       node->value_raw.reserve(lines.size()); // roughly reserve some memory to avoid reallocations
       nodes.push_back(node);
     }
@@ -161,35 +449,34 @@ namespace dip {
 	auto node = nodes.at(i);
 	parser.value_raw.clear();
 	if (parser.part_string()) {
-	  node->value_raw.push_back(parser.value_raw.at(0));
+	  node->value_raw.push_back(std::move(parser.value_raw.at(0)));
 	} else {
-	  throw std::runtime_error("Could not parse column '"+node->name+"' from the table row: "+line.code);
+	  throw std::runtime_error("Could not parse column '"+node->name+"' from the table row: "+std::string(line.code));
 	}
       }
       if (parser.do_continue())
-	throw std::runtime_error("Could not parse all text on the line: "+line.code);
+	throw std::runtime_error("Could not parse all text on the line: "+std::string(line.code));
     }
     return nodes;
   }  
 
-  std::string parse_array(const std::string& value_string, Array::StringType& value_raw, Array::ShapeType& value_shape) {
-    std::stringstream ss(value_string), rm;
+  std::string parse_array(std::string_view value_string, Array::StringType& value_raw, Array::ShapeType& value_shape, const bool skip_newlines) {
+    size_t pos = 0;
     char ch;
 
     // test for an openning bracket
-    ss.get(ch);
-    rm << ch;
-    if (ch!=SIGN_ARRAY_OPEN)
-      throw std::runtime_error("Given source code is not a valid array: "+value_string);
+    if (value_string.empty() or value_string[pos++]!=SIGN_ARRAY_OPEN)
+      throw std::runtime_error("Given source code is not a valid array: "+std::string(value_string));
     
     std::string value;
-    bool inString = false;
     int  dim = 1;
     value_shape.push_back(0);
     
-    while (ss.get(ch) and dim>0) {
-      rm << ch;
-      if (ch == SIGN_ARRAY_OPEN) {
+    while (pos<value_string.size() and dim>0) {
+      ch = value_string[pos++];
+      if (ch == '\n' and skip_newlines) {
+	continue;
+      } else if (ch == SIGN_ARRAY_OPEN) {
 	dim++;
 	if (value_shape.size()<dim)
 	  value_shape.push_back(0);
@@ -207,20 +494,15 @@ namespace dip {
 	}
 	value_shape[dim-1]++;
 	dim--;
-      } else if (ch == '"') {
+      } else if (ch == '"' or ch == '\'') {
 	value.clear();
-	while (ss.get(ch) && ch != '"') {
-	  value += ch;
-	  rm << ch;
+	while (pos<value_string.size() and value_string[pos]!=ch) {
+	  if (value_string[pos]!='\n' or !skip_newlines)
+	    value += value_string[pos];
+	  pos++;
 	}
-	rm << ch;
-      } else if (ch == '\'') {
-	value.clear();
-	while (ss.get(ch) && ch != '\'') {
-	  value += ch;
-	  rm << ch;
-	}
-	rm << ch;
+	if (pos<value_string.size())
+	  pos++;
       } else if (ch == ' ') {
 	continue;
       } else {
@@ -230,30 +512,38 @@ namespace dip {
     
     // Check if all nested arrays are closed
     if (dim!=0)
-      throw std::runtime_error("Definition of an array has some unclosed brackets or quotes: "+value_string);
+      throw std::runtime_error("Definition of an array has some unclosed brackets or quotes: "+std::string(value_string));
+
+    normalize_array_shape(value_shape, value_string);
+    return std::string(value_string.substr(0, pos));
+  }
 
-    // Normalize shape and check coherence of nested arrays
+  // Normalize shape and check coherence of nested arrays
+  void normalize_array_shape(Array::ShapeType& value_shape, std::string_view value_string) {
     int coef = 1;
     for (int d=1; d<value_shape.size(); d++) {
       coef *= value_shape[d-1];
       if (value_shape[d]%coef != 0) 
-	throw std::runtime_error("Items in dimension "+std::to_string(d+1)+" do not have the same shape: "+value_string);
+	throw std::runtime_error("Items in dimension "+std::to_string(d+1)+" do not have the same shape: "+std::string(value_string));
       value_shape[d] /= coef;
     }    
-    //std::cout << ss.str() << std::endl;
-    //std::cout << rm.str() << std::endl;
-    return rm.str();
   }
 
-  void parse_value(std::string value_string, Array::StringType& value_raw, Array::ShapeType& value_shape) {
+  std::string_view parse_value(std::string_view value_string, Array::StringType& value_raw, Array::ShapeType& value_shape, const bool keep_arrays) {
+    // newlines are ignored, so large multi-line arrays are parsed directly from the source buffer
     trim(value_string);
-    value_string.erase(std::remove(value_string.begin(), value_string.end(), '\n'), value_string.end());
     if (value_string.empty())
       throw std::runtime_error("Source code of the value is empty");
+    else if (value_string.at(0)==SIGN_ARRAY_OPEN and keep_arrays)
+      return value_string.substr(0, scan_array(value_string, value_shape, [](std::string_view) {}));
     else if (value_string.at(0)==SIGN_ARRAY_OPEN)
-      parse_array(value_string, value_raw, value_shape);
-    else
-      value_raw.push_back(value_string);
+      parse_array(value_string, value_raw, value_shape, true);
+    else {
+      std::string value(value_string);
+      value.erase(std::remove(value.begin(), value.end(), '\n'), value.end());
+      value_raw.push_back(value);
+    }
+    return {};
   }
 
   void parse_slices(std::string& value_string, Array::RangeType& dimension) {
@@ -1,16 +1,130 @@
 #ifndef DIP_PARSERS_H
 #define DIP_PARSERS_H
 
+#include <deque>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
 #include "lists/lists.h"
 
 namespace dip {
 
+  struct SourceCacheStats {
+    size_t hits;    // number of sources taken from the cache
+    size_t misses;  // number of parsed sources
+  };
+  SourceCacheStats source_cache_stats();
+  void clear_source_cache();
+  
   EnvSource parse_source(const std::string& source_name, const std::string& source_file, const Source& parent);
-  std::queue<Line> parse_lines(std::queue<Line>& lines, const std::string& source_code, const std::string& source_name);
-  BaseNode::NodeListType parse_code_nodes(std::queue<Line>& lines);
+
+  // Parse independent sources concurrently on a fixed number of worker threads.
+  // Sources are queued with add() and their results can be retrieved from the returned futures.
+  // Unstarted sources are cancelled and all threads are joined when the object is destroyed.
+  class SourcePrefetch {
+  private:
+    struct Task {
+      std::string name;
+      std::string path;
+      Source parent;
+      std::promise<std::shared_ptr<EnvSource>> result;
+    };
+    std::deque<Task> tasks;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next_task;
+    std::atomic<bool> cancelled;
+    void work();
+  public:
+    SourcePrefetch(): next_task(0), cancelled(false) {};
+    SourcePrefetch(const SourcePrefetch&) = delete;
+    SourcePrefetch& operator=(const SourcePrefetch&) = delete;
+    ~SourcePrefetch();
+    std::shared_future<std::shared_ptr<EnvSource>> add(const std::string& source_name, const std::string& source_file, const Source& parent);
+    void start(const size_t num_threads);
+    size_t size() const {return tasks.size();};
+  };
+  std::queue<Line> parse_lines(std::queue<Line>& lines, const SourceCode& source_code, const std::string& source_name, const int first_line=0);
+  std::queue<Line> parse_lines(std::queue<Line>& lines, const std::string& source_code, const std::string& source_name, const int first_line=0);
+  // Lines are classified on up to num_threads threads; the order of the nodes does not depend on it.
+  // In the lazy mode lines inside of case branches are returned unclassified as lazy nodes.
+  BaseNode::NodeListType parse_code_nodes(std::queue<Line>& lines, const size_t num_threads=1, const bool lazy=false);
   BaseNode::NodeListType parse_table_nodes(std::queue<Line>& lines, const char delimiter);
-  std::string parse_array(const std::string& value_string, Array::StringType& value_raw, Array::ShapeType& value_shape);
-  void parse_value(std::string value_string, Array::StringType& value_raw, Array::ShapeType& value_shape);
+  std::string parse_array(std::string_view value_string, Array::StringType& value_raw, Array::ShapeType& value_shape, const bool skip_newlines=false);
+  // Array literals are not split into value_raw if keep_arrays is set; the literal is returned instead
+  std::string_view parse_value(std::string_view value_string, Array::StringType& value_raw, Array::ShapeType& value_shape, const bool keep_arrays=false);
+  void normalize_array_shape(Array::ShapeType& value_shape, std::string_view value_string);
+
+  // Scan an array literal and pass views of its elements to the given function, while the shape is counted.
+  // Spaces and newlines between the elements are ignored. Returns the length of the literal.
+  template <typename F>
+  size_t scan_array(std::string_view value_string, Array::ShapeType& value_shape, F&& element) {
+    size_t pos = 0;
+    if (value_string.empty() or value_string[pos++]!=SIGN_ARRAY_OPEN)
+      throw std::runtime_error("Given source code is not a valid array: "+std::string(value_string));
+    int dim = 1;
+    value_shape.assign(1, 0);
+    while (pos<value_string.size() and dim>0) {
+      char ch = value_string[pos];
+      if (ch==SIGN_ARRAY_OPEN) {
+	dim++;
+	if (value_shape.size()<dim)
+	  value_shape.push_back(0);
+	pos++;
+      } else if (ch==SEPARATOR_ARRAY) {
+	value_shape[dim-1]++;
+	pos++;
+      } else if (ch==SIGN_ARRAY_CLOSE) {
+	value_shape[dim-1]++;
+	dim--;
+	pos++;
+      } else if (ch==' ' or ch==SEPARATOR_NEWLINE) {
+	pos++;
+      } else if (ch=='"' or ch=='\'') {
+	size_t end = value_string.find(ch, pos+1);
+	if (end==std::string_view::npos)
+	  break;
+	element(value_string.substr(pos+1, end-pos-1));
+	pos = end+1;
+      } else {
+	size_t end = value_string.find_first_of(" \n,[]", pos);
+	if (end==std::string_view::npos)
+	  end = value_string.size();
+	element(value_string.substr(pos, end-pos));
+	pos = end;
+      }
+    }
+    if (dim!=0)
+      throw std::runtime_error("Definition of an array has some unclosed brackets or quotes: "+std::string(value_string));
+    normalize_array_shape(value_shape, value_string);
+    return pos;
+  }
+
+  // Convert an array literal directly into a contiguous buffer of numbers
+  template <typename T>
+  std::vector<T> parse_array_numbers(std::string_view value_string, Array::ShapeType& value_shape) {
+    std::vector<T> numbers;
+    numbers.reserve(std::count(value_string.begin(), value_string.end(), SEPARATOR_ARRAY)+1);
+    scan_array(value_string, value_shape, [&numbers](std::string_view element) {
+      numbers.push_back(parse_number<T>(element));
+    });
+    size_t size = 1;
+    for (int dim: value_shape)
+      size *= dim;
+    if (size!=numbers.size())
+      throw std::runtime_error("Number of array items does not correspond with the array shape: "+std::string(value_string));
+    return numbers;
+  }
+
+  // Convert array values from their literal if it is given, otherwise from strings of individual elements
+  template <typename T>
+  std::vector<T> parse_array_numbers(const Array::StringType& value_inputs, std::string_view value_literal) {
+    if (value_literal.empty())
+      return parse_numbers<T>(value_inputs);
+    Array::ShapeType value_shape;
+    return parse_array_numbers<T>(value_literal, value_shape);
+  }
   void parse_slices(std::string& value_string, Array::RangeType& dimension);
   
 }
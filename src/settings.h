@@ -2,7 +2,11 @@
 #define DIP_SETTINGS_H
 
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <memory>
+#include <vector>
+#include <cstdint>
 #include <scnt-puq/quantity.h>
 
 namespace dip {
@@ -13,6 +17,7 @@ namespace dip {
   constexpr std::string_view STRING_SOURCE  = "STRING";
   constexpr std::string_view DIRECT_SOURCE  = "SOURCE";
   constexpr std::string_view TABLE_SOURCE   = "TABLE";
+  constexpr std::string_view STREAM_SOURCE  = "STREAM";
 
   // Parsing separators
   constexpr char SEPARATOR_NEWLINE                   = '\n';
@@ -59,6 +64,9 @@ namespace dip {
   constexpr std::string_view KEYWORD_SOURCE      = "source";
   constexpr std::string_view KEYWORD_UNIT        = "unit";
 
+  // Parallel parsing
+  constexpr size_t MIN_PARALLEL_LINES = 1024;   // minimal number of code lines classified by a single thread
+
   // Regex Patterns
   constexpr std::string_view PATTERN_KEY  = "[a-zA-Z0-9_-]";
   constexpr std::string_view PATTERN_PATH = "[a-zA-Z0-9._-]";
@@ -66,20 +74,80 @@ namespace dip {
   // Various settings
   constexpr int DISPLAY_FLOAT_PRECISION      = 4;
   constexpr std::string_view FILE_SUFFIX_DIP = ".dip";
+  constexpr size_t MAX_CACHED_SOURCES        = 64;      // least recently used sources are evicted from the cache
+  constexpr size_t MIN_MAPPED_SIZE           = 1048576; // smaller files are read into memory instead of being mapped
+  constexpr int MIN_STABLE_SOURCE_AGE        = 2;       // seconds after a modification when the time of a cached source file is trusted
+  
+  // Source code is stored in an immutable shared buffer and code lines only
+  // point into it, so that a source is not copied for every parsed line.
+  // Buffers of large regular files are memory-mapped instead of being read into memory.
+  class SourceBuffer {
+  private:
+    std::string text;                      // code held in memory
+    void* mapping;                         // address of a memory-mapped file
+    size_t mapping_size;                   // size of the memory-mapped file
+    std::string_view code;                 // view of the whole code
+    SourceBuffer(void* addr, const size_t size);
+  public:
+    SourceBuffer(std::string c="");
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    ~SourceBuffer();
+    static std::shared_ptr<const SourceBuffer> from_file(const std::string& path);
+    std::string_view view() const {return code;};
+    const char* data() const {return code.data();};
+    size_t size() const {return code.size();};
+    bool is_mapped() const {return mapping!=nullptr;};
+    bool operator==(std::string_view other) const {return code==other;};
+    friend std::ostream& operator<<(std::ostream& os, const SourceBuffer& buffer) {
+      return os << buffer.code;
+    };
+  };
+  typedef std::shared_ptr<const SourceBuffer> SourceCode;
+
+  // Lines of a source share a single copy of its name
+  typedef std::shared_ptr<const std::string> SourceName;
+
+  // Node names are interned in a path table of their environment (see PathTable in lists.h)
+  typedef uint32_t PathId;                 // ID 0 is the empty path
+  typedef uint32_t SymbolId;               // ID of a single name segment
   
   struct Source {
-    std::string name;
+    SourceName shared_name;                // name shared by all lines of the source
     int line_number;
+    Source(): line_number(0) {};
+    Source(const SourceName& nm, const int ln): shared_name(nm), line_number(ln) {};
+    Source(const std::string& nm, const int ln): shared_name(std::make_shared<const std::string>(nm)), line_number(ln) {};
+    const std::string& name() const {
+      static const std::string empty;
+      return shared_name ? *shared_name : empty;
+    };
   };
 
   struct Line {
-    std::string code;
-    Source source;
+    std::string_view code;                 // code of the line
+    Source source;                         // source of the line
+    SourceCode buffer;                     // buffer that holds the code
+    Line() {};
+    Line(std::string_view c, const Source& s, const SourceCode& b): code(c), source(s), buffer(b) {};
+    Line(std::string c, const Source& s): source(s), buffer(std::make_shared<const SourceBuffer>(std::move(c))) {
+      code = buffer->view();
+    };
     std::string to_string() {
       std::ostringstream oss;
-      oss << "[" << source.name << ":" << source.line_number << "] " << code;
+      oss << "[" << source.name() << ":" << source.line_number << "] " << code;
       return oss.str();
     };
+    // code of the line, or only its location if the code was already released
+    std::string code_or_location() const {
+      if (buffer!=nullptr)
+	return std::string(code);
+      return "["+source.name()+":"+std::to_string(source.line_number)+"]";
+    };
+    void release() {
+      code = {};
+      buffer = nullptr;
+    };
   };  
 
   enum class CaseType {
@@ -90,6 +158,7 @@ namespace dip {
   
   // Forward declarations
   class Environment;
+  struct EnvSource;
 
   // Define a pointer type for SCNT-PUQ Quantity
   // TODO: move this to the puq
@@ -25,7 +25,7 @@ namespace dip {
       if (node==nullptr) node = StringNode::is_node(parser);
       if (node==nullptr)
 	throw std::runtime_error("Value could not be determined from : "+s);
-      ValueNode::PointerType vnode = std::dynamic_pointer_cast<ValueNode>(node);
+      ValueNode::PointerType vnode = to_value_node(node);
       vnode->set_value();
       return std::move(vnode->value);
     } else {
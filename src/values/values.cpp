@@ -1,4 +1,5 @@
 #include <map>
+#include <cmath>
 
 #include "values.h"
 
@@ -20,4 +21,23 @@ namespace dip {
     {ValueDtype::FloatX,      "floatx"}
   };
 
+  // Conversion coefficients are determined from converted probe values 1, 2 and 3; positive probes
+  // stay in the domain of logarithmic units and the middle probe verifies that the conversion is affine.
+  // Errors of puq, e.g. puq::ConvDimExcept for incompatible units, are not caught, because a direct
+  // conversion of the values would raise them as well.
+  UnitConversion unit_conversion(const std::string& from_units, const std::string& to_units) {
+    puq::Quantity quantity = puq::Quantity(std::vector<double>({1,2,3}), from_units);
+    quantity = quantity.convert(to_units);
+    const std::vector<double>& output = quantity.value.magnitude.value.value;
+    UnitConversion conversion;
+    if (output.size()!=3 or !std::isfinite(output[0]) or !std::isfinite(output[1]) or !std::isfinite(output[2]))
+      return conversion;
+    // the factor is taken over the whole probed span, so that a large offset does not reduce its precision
+    conversion.factor = (output[2]-output[0])/2;
+    conversion.offset = output[0]-conversion.factor;
+    double expected = conversion.offset+2*conversion.factor;
+    conversion.linear = std::fabs(output[1]-expected) <= 1e-12*std::max(std::fabs(output[1]), 1.0);
+    return conversion;
+  }
+
 }
@@ -2,6 +2,9 @@
 #define DIP_VALUES_H
 
 #include <typeinfo>
+#include <charconv>
+#include <system_error>
+#include <cmath>
 
 #include "../settings.h"
 
@@ -16,6 +19,73 @@ namespace dip {
 
   extern std::unordered_map<ValueDtype, std::string> ValueDtypeNames;
 
+  // Value data type of a numeric C++ type
+  template <typename T>
+  constexpr ValueDtype number_dtype() {
+    if constexpr (std::is_same_v<T, short>)                   return ValueDtype::Integer16;
+    else if constexpr (std::is_same_v<T, unsigned short>)     return ValueDtype::Integer16_U;
+    else if constexpr (std::is_same_v<T, int>)                return ValueDtype::Integer32;
+    else if constexpr (std::is_same_v<T, unsigned int>)       return ValueDtype::Integer32_U;
+    else if constexpr (std::is_same_v<T, long long>)          return ValueDtype::Integer64;
+    else if constexpr (std::is_same_v<T, unsigned long long>) return ValueDtype::Integer64_U;
+    else if constexpr (std::is_same_v<T, float>)              return ValueDtype::Float32;
+    else if constexpr (std::is_same_v<T, double>)             return ValueDtype::Float64;
+    else if constexpr (std::is_same_v<T, long double>)        return ValueDtype::Float128;
+    else static_assert(sizeof(T)==0, "Unsupported numeric type");
+  }
+
+  // Convert a string into a number; the whole string has to be a number within the range of the type.
+  // Values of parsed nodes use it, while numeric casts of string values stay lenient as std::stoi and std::stod
+  template <typename T>
+  T parse_number(std::string_view str) {
+    const char* begin = str.data();
+    const char* end = str.data()+str.size();
+    bool plus = (begin!=end and *begin=='+');
+    if (plus)
+      begin++;
+    T number;
+    auto [ptr, ec] = std::from_chars(begin, end, number);
+    if (ec==std::errc::result_out_of_range)
+      throw std::runtime_error("Value is out of the range of "+ValueDtypeNames.at(number_dtype<T>())+" type: "+std::string(str));
+    if (ec!=std::errc() or ptr!=end or (plus and *begin=='-'))
+      throw std::runtime_error("Value cannot be converted to "+ValueDtypeNames.at(number_dtype<T>())+" type: "+std::string(str));
+    return number;
+  }
+
+  // Convert strings of array elements into numbers
+  template <typename T>
+  std::vector<T> parse_numbers(const Array::StringType& strs) {
+    std::vector<T> numbers(strs.size());
+    for (size_t i=0; i<strs.size(); i++)
+      numbers[i] = parse_number<T>(strs[i]);
+    return numbers;
+  }
+
+  // Coefficients of a unit conversion, so that converted values are value*factor+offset
+  struct UnitConversion {
+    double factor = 1;
+    double offset = 0;
+    bool linear = false; // false if the conversion cannot be expressed by a factor and an offset
+  };
+
+  // Coefficients of a conversion between two units; they are cached by UnitList::conversion
+  UnitConversion unit_conversion(const std::string& from_units, const std::string& to_units);
+
+  // Apply conversion coefficients to a single number. Integer results are truncated, as after a conversion by puq,
+  // except for results that differ from an integer only by rounding errors of the factor,
+  // e.g. 49 converted with the factor 1/49 gives 1 instead of 0.
+  template <typename T, typename C>
+  inline T convert_number(const T value, const C factor, const C offset) {
+    C converted = value*factor+offset;
+    if constexpr (std::is_integral_v<T>) {
+      C rounded = std::nearbyint(converted);
+      // results that are integers up to rounding errors of the factor are not truncated
+      return static_cast<T>((std::fabs(converted-rounded) <= 1e-9*std::fabs(rounded)) ? rounded : converted);
+    } else {
+      return static_cast<T>(converted);
+    }
+  }
+
   template <typename T>
   class ArrayValue;
   
@@ -33,6 +103,7 @@ namespace dip {
     virtual BaseValue::PointerType slice(const Array::RangeType& slice) = 0;
     virtual void convert_units(const std::string& from_units, const Quantity::PointerType& to_quantity) = 0;
     virtual void convert_units(const Quantity::PointerType& from_quantity, const std::string& to_units) = 0;
+    virtual void convert_units(const UnitConversion& conversion) = 0;
     virtual bool operator==(const BaseValue* other) const = 0;
     virtual bool operator<(const BaseValue* other) const = 0;
     virtual explicit operator bool() const = 0;
@@ -4,23 +4,31 @@
 #include <typeinfo>
 
 #include "../settings.h"
+#include "values_bits.h"
 
 namespace dip {
   
   // Array values
 
   template <typename T> class ArrayValue; // here we need a forward declaration
+
+  // boolean arrays are stored bit-packed
+  template <typename T> struct ArrayStorage {typedef std::vector<T> type;};
+  template <> struct ArrayStorage<bool> {typedef BitArray type;};
   
   template <typename T>
   class BaseArrayValue: public BaseValue {
+  public:
+    typedef typename ArrayStorage<T>::type StorageType;
   protected:
-    std::vector<T> value;
+    StorageType value;
     Array::ShapeType shape;
   public:
     BaseArrayValue(const T& val, const Array::ShapeType& sh, const ValueDtype dt): value({val}), shape(sh), BaseValue(dt) {};
-    BaseArrayValue(const std::vector<T>&  arr, const Array::ShapeType& sh, const ValueDtype dt): value(arr), shape(sh), BaseValue(dt) {};
+    BaseArrayValue(const StorageType&  arr, const Array::ShapeType& sh, const ValueDtype dt): value(arr), shape(sh), BaseValue(dt) {};
+    BaseArrayValue(StorageType&& arr, const Array::ShapeType& sh, const ValueDtype dt): value(std::move(arr)), shape(sh), BaseValue(dt) {};
     void print() override {std::cout << to_string() << std::endl;};
-    std::vector<T> get_value() {return value;};
+    const StorageType& get_value() const {return value;};
     Array::ShapeType get_shape() const override {return shape;};
     size_t get_size() const override {return value.size();};
   protected:
@@ -52,14 +60,8 @@ namespace dip {
     bool operator==(const BaseValue* other) const override {
       const BaseArrayValue<T>* otherT = dynamic_cast<const BaseArrayValue<T>*>(other);
       if (otherT) {
-	bool is_equal = true;
-	for (int i=0; i<value.size();i++)
-	  if (value[i]!=otherT->value[i])
-	    is_equal = false;
-	for (int i=0; i<shape.size();i++)
-	  if (shape[i]!=otherT->shape[i])
-	    is_equal = false;	
-	return is_equal;
+	// packed boolean arrays are compared word by word
+	return value==otherT->value and shape==otherT->shape;
       } else {
 	throw std::runtime_error("Could not convert BaseValue into a BaseArrayValue");
       }
@@ -83,41 +85,52 @@ namespace dip {
       if (slice.size()!=this->shape.size())
 	throw std::runtime_error("Array slice size does not correspond with array shape: "+std::to_string(slice.size())+"!="+std::to_string(this->shape.size()));
       // calculate new shape and size
+      size_t ndim = this->shape.size();
       Array::ShapeType new_shape;
-      size_t new_size = 0;
-      for (size_t i=0; i<this->shape.size(); i++) {
-	int dmin = slice[i].dmin;
-	int dmax = (slice[i].dmax==Array::max_range) ? this->shape[i]-1 : slice[i].dmax;
+      std::vector<size_t> lower(ndim), counts(ndim), strides(ndim, 1);
+      size_t new_size = 1;
+      for (size_t i=0; i<ndim; i++) {
+	// ranges are clipped to the array shape; only slices without any element are invalid
+	int dmin = std::max(slice[i].dmin, 0);
+	int dmax = std::min<int>((slice[i].dmax==Array::max_range) ? this->shape[i]-1 : slice[i].dmax, this->shape[i]-1);
+	if (dmax<dmin)
+	  throw std::runtime_error("Array slice is out of the array range: "+std::to_string(slice[i].dmin)+":"+std::to_string(slice[i].dmax)+
+				   " not in 0:"+std::to_string(this->shape[i]-1));
 	int new_dim = dmax + 1 - dmin;
 	if (new_dim>1) {
 	  new_shape.push_back(new_dim);
-	  new_size += new_dim;
+	  new_size *= new_dim;
 	}
+	lower[i] = dmin;
+	counts[i] = new_dim;
       }
-      // allocate variables
-      std::vector<T> new_value;
+      for (size_t i=ndim-1; i-->0;)
+	strides[i] = strides[i+1]*this->shape[i+1];
+      // copy contiguous runs of the last dimension; outer dimensions are traversed by their strides
+      StorageType new_value;
       new_value.reserve(new_size);
-      Array::ShapeType coord(this->shape.size(),0);
-      // list through all values and copy sliced
-      for (size_t i=0; i<this->value.size(); i++) {
-	// copy only values within the given ranges
-	bool push = true;
-	for (size_t dim = 0; dim<this->shape.size(); dim++) {
-	  int dmin = slice[dim].dmin;
-	  int dmax = (slice[dim].dmax==Array::max_range) ? this->shape[dim]-1 : slice[dim].dmax;
-	  if (coord[dim]<dmin or dmax<coord[dim])
-	    push = false;
-	}
-	if (push)
-	  new_value.push_back(this->value[i]);
-	// increase the coodrinates
-	for (size_t dim = this->shape.size(); dim-->0;) {
-	  if (++coord[dim] < this->shape[dim]) break;
-	  coord[dim] = 0;  // carry over
+      std::vector<size_t> index(ndim, 0);
+      size_t run = counts[ndim-1];
+      bool done = false;
+      while (!done) {
+	size_t offset = lower[ndim-1];
+	for (size_t dim=0; dim+1<ndim; dim++)
+	  offset += (lower[dim]+index[dim])*strides[dim];
+	if constexpr (std::is_same_v<T, bool>)
+	  new_value.append(this->value, offset, run);
+	else
+	  new_value.insert(new_value.end(), this->value.begin()+offset, this->value.begin()+offset+run);
+	done = true;
+	for (size_t dim=ndim-1; dim-->0;) {
+	  if (++index[dim]<counts[dim]) {
+	    done = false;
+	    break;
+	  }
+	  index[dim] = 0;  // carry over
 	}
       }
       if (new_size>1)
-	return std::make_unique<ArrayValue<T>>(new_value, new_shape, this->dtype);
+	return std::make_unique<ArrayValue<T>>(std::move(new_value), new_shape, this->dtype);
       else
 	return std::make_unique<ScalarValue<T>>(new_value[0], this->dtype);
     };
@@ -127,6 +140,9 @@ namespace dip {
     void convert_units(const Quantity::PointerType& from_quantity, const std::string& to_units) override {
       throw std::runtime_error("Array value of type '"+std::string(ValueDtypeNames[dtype])+"' does not support unit conversion.");
     };
+    void convert_units(const UnitConversion& conversion) override {
+      throw std::runtime_error("Array value of type '"+std::string(ValueDtypeNames[dtype])+"' does not support unit conversion.");
+    };
     explicit operator bool() const override {
       // TODO: Implement bool conversion of arrays
       throw std::runtime_error("Bool conversion of arrays is not implemented!!!");
@@ -168,6 +184,7 @@ namespace dip {
   public:
     ArrayValue(const T& val, const Array::ShapeType& sh, const ValueDtype dt): BaseArrayValue<T>(val,sh,dt) {};
     ArrayValue(const std::vector<T>&  arr, const Array::ShapeType& sh, const ValueDtype dt): BaseArrayValue<T>(arr,sh,dt) {};
+    ArrayValue(std::vector<T>&& arr, const Array::ShapeType& sh, const ValueDtype dt): BaseArrayValue<T>(std::move(arr),sh,dt) {};
   private:
     void value_to_string(std::ostringstream& oss, size_t& offset, int precision=0) const override {
       if (precision==0) precision=DISPLAY_FLOAT_PRECISION;
@@ -200,6 +217,16 @@ namespace dip {
       std::vector<double> output = quantity.value.magnitude.value.value;
       std::copy(output.begin(), output.end(), this->value.begin());
     };
+    // apply linear conversion coefficients in place; the loop is simple enough to be vectorized by the compiler
+    void convert_units(const UnitConversion& conversion) override {
+      typedef std::conditional_t<std::is_same_v<T, long double>, long double, double> C;
+      const C factor = conversion.factor;
+      const C offset = conversion.offset;
+      T* data = this->value.data();
+      const size_t size = this->value.size();
+      for (size_t i=0; i<size; i++)
+	data[i] = convert_number<T, C>(data[i], factor, offset);
+    };
   };
   
   template <>
@@ -234,7 +261,9 @@ namespace dip {
   class ArrayValue<bool>: public BaseArrayValue<bool> {
   public:
     ArrayValue(const bool& val, const Array::ShapeType& sh, const ValueDtype dt): BaseArrayValue<bool>(val,sh,dt) {};
-    ArrayValue(const std::vector<bool>&  arr, const Array::ShapeType& sh, const ValueDtype dt): BaseArrayValue<bool>(arr,sh,dt) {};
+    ArrayValue(const std::vector<bool>&  arr, const Array::ShapeType& sh, const ValueDtype dt): BaseArrayValue<bool>(BitArray(arr),sh,dt) {};
+    ArrayValue(const BitArray&  arr, const Array::ShapeType& sh, const ValueDtype dt): BaseArrayValue<bool>(arr,sh,dt) {};
+    ArrayValue(BitArray&& arr, const Array::ShapeType& sh, const ValueDtype dt): BaseArrayValue<bool>(std::move(arr),sh,dt) {};
     ArrayValue(const bool& val, const Array::ShapeType& sh): ArrayValue(val,sh,ValueDtype::Boolean) {};
     ArrayValue(const std::vector<bool>&  arr, const Array::ShapeType& sh): ArrayValue(arr,sh,ValueDtype::Boolean) {};
   private:
@@ -253,6 +282,10 @@ namespace dip {
 	throw std::runtime_error("Boolean value does not support precision parameter for to_string() method.");
       }
     };
+    size_t count() const {return value.count();};
+    bool any() const {return value.any();};
+    bool all() const {return value.all();};
+    std::vector<uint8_t> to_bytes() const {return value.to_bytes();};
     BaseValue::PointerType clone() const override {
       return std::make_unique<ArrayValue<bool>>(this->value, this->shape, this->dtype);
     };
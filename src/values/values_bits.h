@@ -0,0 +1,111 @@
+#ifndef DIP_VALUES_BITS_H
+#define DIP_VALUES_BITS_H
+
+#include <vector>
+#include <cstdint>
+#include <bit>
+#include <initializer_list>
+
+namespace dip {
+
+  // Packed storage of boolean array values; unused bits of the last word are always kept zero
+  class BitArray {
+  public:
+    typedef uint64_t WordType;
+    static constexpr size_t WORD_BITS = 64;
+  private:
+    std::vector<WordType> words;
+    size_t nbits = 0;
+    // read up to WORD_BITS bits starting at the given bit position
+    WordType get_bits(size_t pos, size_t count) const {
+      size_t w = pos/WORD_BITS, b = pos%WORD_BITS;
+      WordType bits = words[w] >> b;
+      if (b>0 and b+count>WORD_BITS)
+	bits |= words[w+1] << (WORD_BITS-b);
+      return (count<WORD_BITS) ? bits & ((WordType(1)<<count)-1) : bits;
+    }
+    // append up to WORD_BITS bits at the end of the array
+    void put_bits(WordType bits, size_t count) {
+      size_t b = nbits%WORD_BITS;
+      if (b==0)
+	words.push_back(bits);
+      else {
+	words.back() |= bits << b;
+	if (b+count>WORD_BITS)
+	  words.push_back(bits >> (WORD_BITS-b));
+      }
+      nbits += count;
+    }
+  public:
+    BitArray() = default;
+    BitArray(std::initializer_list<bool> arr) {
+      reserve(arr.size());
+      for (bool val: arr)
+	push_back(val);
+    }
+    BitArray(const std::vector<bool>& arr) {
+      reserve(arr.size());
+      for (bool val: arr)
+	push_back(val);
+    }
+    size_t size() const {return nbits;};
+    bool empty() const {return nbits==0;};
+    const std::vector<WordType>& data() const {return words;};
+    void reserve(size_t count) {words.reserve((count+WORD_BITS-1)/WORD_BITS);};
+    bool operator[](size_t i) const {
+      return (words[i/WORD_BITS] >> (i%WORD_BITS)) & 1;
+    }
+    void set(size_t i, bool val) {
+      WordType mask = WordType(1) << (i%WORD_BITS);
+      if (val)
+	words[i/WORD_BITS] |= mask;
+      else
+	words[i/WORD_BITS] &= ~mask;
+    }
+    void push_back(bool val) {
+      if (nbits%WORD_BITS==0)
+	words.push_back(0);
+      if (val)
+	words.back() |= WordType(1) << (nbits%WORD_BITS);
+      nbits++;
+    }
+    // append a range of bits from another array, copying a word at a time
+    void append(const BitArray& other, size_t offset, size_t count) {
+      words.reserve((nbits+count+WORD_BITS-1)/WORD_BITS);
+      while (count>0) {
+	size_t n = (count<WORD_BITS) ? count : WORD_BITS;
+	put_bits(other.get_bits(offset, n), n);
+	offset += n;
+	count -= n;
+      }
+    }
+    // number of true values
+    size_t count() const {
+      size_t total = 0;
+      for (WordType word: words)
+	total += std::popcount(word);
+      return total;
+    }
+    bool any() const {
+      for (WordType word: words)
+	if (word) return true;
+      return false;
+    }
+    bool all() const {
+      return count()==nbits;
+    }
+    bool operator==(const BitArray& other) const {
+      return nbits==other.nbits and words==other.words;
+    }
+    // unpack values into one byte per value, e.g. for solver masks
+    std::vector<uint8_t> to_bytes() const {
+      std::vector<uint8_t> bytes(nbits);
+      for (size_t i=0; i<nbits; i++)
+	bytes[i] = (*this)[i];
+      return bytes;
+    }
+  };
+
+}
+
+#endif // DIP_VALUES_BITS_H
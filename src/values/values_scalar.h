@@ -54,6 +54,9 @@ namespace dip {
     void convert_units(const Quantity::PointerType& from_quantity, const std::string& to_units) override {
       throw std::runtime_error("Scalar value of type '"+std::string(ValueDtypeNames[dtype])+"' does not support unit conversion.");
     };
+    void convert_units(const UnitConversion& conversion) override {
+      throw std::runtime_error("Scalar value of type '"+std::string(ValueDtypeNames[dtype])+"' does not support unit conversion.");
+    };
   };
   
   template <typename T>
@@ -85,6 +88,10 @@ namespace dip {
       quantity = quantity.convert(to_units);
       this->value = quantity.value.magnitude.value.value.at(0);
     };
+    void convert_units(const UnitConversion& conversion) override {
+      typedef std::conditional_t<std::is_same_v<T, long double>, long double, double> C;
+      this->value = convert_number<T, C>(this->value, conversion.factor, conversion.offset);
+    };
     explicit operator bool() const override {
       return static_cast<bool>(this->value);
     };